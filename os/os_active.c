@@ -0,0 +1,151 @@
+/*! \file
+ * \brief eeOS Active Objects
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+#if CONFIG_OS_USE_ACTIVE == true
+
+/*! \brief Append an active object to the ready list of its executor
+ * \param ao The active object
+ * \warning This function must be called inside a critical section.
+ */
+static void __os_active_ready(struct os_active *ao)
+{
+	struct os_executor *executor = ao->executor;
+
+	ao->next = NULL;
+	if (executor->first[ao->priority]) {
+		executor->last[ao->priority]->next = ao;
+	}
+	else {
+		executor->first[ao->priority] = ao;
+		executor->ready |= (1UL << ao->priority);
+	}
+	executor->last[ao->priority] = ao;
+	ao->is_ready = true;
+}
+
+/*! \brief Main loop of an executor
+ * \param args The executor
+ */
+static void __os_executor_loop(os_ptr_t args)
+{
+	struct os_executor *executor = (struct os_executor *) args;
+	struct os_active *ao;
+	struct os_active_msg msg;
+	int level;
+
+	while (true) {
+		os_enter_critical();
+		/* Nothing to do, sleep until a message is posted */
+		while (!executor->ready) {
+			__os_process_disable_naked(__os_process_get_current());
+			os_switch_context(false);
+		}
+		/* Pick the first ready object of the highest priority level */
+		level = ctz(executor->ready);
+		ao = executor->first[level];
+		executor->first[level] = ao->next;
+		if (!ao->next) {
+			executor->ready &= ~(1UL << level);
+		}
+		/* Get its first message */
+		msg = ao->buffer[ao->first];
+		ao->first = (ao->first + 1) % ao->size;
+		ao->count--;
+		/* If the object has more messages, it goes back at the end of
+		 * its level, so that the objects of the same priority are served
+		 * in turn.
+		 */
+		if (ao->count) {
+			__os_active_ready(ao);
+		}
+		else {
+			ao->is_ready = false;
+		}
+		os_leave_critical();
+		/* Run to completion, with the interrupts enabled */
+		ao->dispatch(ao, &msg);
+	}
+}
+
+bool os_executor_create(struct os_executor *executor, int stack_size,
+		enum os_task_option options)
+{
+	int level;
+
+	for (level = 0; level < CONFIG_OS_ACTIVE_NB_PRIORITIES; level++) {
+		executor->first[level] = NULL;
+		executor->last[level] = NULL;
+	}
+	executor->ready = 0;
+
+	return os_task_create(&executor->task, __os_executor_loop,
+			(os_ptr_t) executor, stack_size, options);
+}
+
+void os_active_create(struct os_active *ao, struct os_executor *executor,
+		os_active_dispatch_t dispatch, os_ptr_t args,
+		struct os_active_msg *buffer, uint8_t size, uint8_t priority)
+{
+	ao->executor = executor;
+	ao->dispatch = dispatch;
+	ao->args = args;
+	ao->buffer = buffer;
+	ao->size = size;
+	ao->first = 0;
+	ao->count = 0;
+	ao->priority = (priority < CONFIG_OS_ACTIVE_NB_PRIORITIES) ? priority
+			: CONFIG_OS_ACTIVE_NB_PRIORITIES - 1;
+	ao->next = NULL;
+	ao->is_ready = false;
+}
+
+bool os_active_post(struct os_active *ao, uint16_t signal, os_ptr_t data)
+{
+	struct os_process *proc;
+	struct os_active_msg *msg;
+	bool is_posted = false;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	if (ao->count < ao->size) {
+		/* Queue the message */
+		msg = &ao->buffer[(ao->first + ao->count) % ao->size];
+		msg->signal = signal;
+		msg->data = data;
+		ao->count++;
+		is_posted = true;
+		/* Make the object ready and wake up its executor */
+		if (!ao->is_ready) {
+			__os_active_ready(ao);
+			proc = __os_task_get_process(&ao->executor->task);
+			if (!__os_process_is_enabled(proc)) {
+				__os_process_enable_naked(proc);
+			}
+		}
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return is_posted;
+}
+
+#endif
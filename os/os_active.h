@@ -0,0 +1,222 @@
+/*! \file
+ * \brief eeOS Active Objects
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_ACTIVE_H__
+#define __OS_ACTIVE_H__
+
+/*! \addtogroup group_os
+ * \section section_os_active Active Objects
+ *
+ * An active object (\ref os_active) is an event-driven state machine. It owns
+ * a private queue of messages (\ref os_active_msg) and a dispatch function,
+ * which handles one message at a time and runs to completion: it must return
+ * without blocking.
+ *
+ * Active objects do not have a stack. They are run by an executor
+ * (\ref os_executor), a task which dispatches the messages of all the active
+ * objects attached to it. An active object with pending messages is ready,
+ * and the executor always runs the ready object of the highest priority
+ * (\ref CONFIG_OS_ACTIVE_NB_PRIORITIES). Objects of the same priority are
+ * served in turn, one message each. The executor sleeps while none of its
+ * objects is ready.
+ *
+ * \code
+ * static void my_dispatch(struct os_active *ao,
+ *		const struct os_active_msg *msg)
+ * {
+ *	switch (msg->signal) {
+ *	...
+ *	}
+ * }
+ * static struct os_active_msg my_buffer[8];
+ * struct os_executor my_executor;
+ * struct os_active my_ao;
+ * os_executor_create(&my_executor, 1024, OS_TASK_DEFAULT);
+ * os_active_create(&my_ao, &my_executor, my_dispatch, NULL, my_buffer, 8, 0);
+ * os_active_post(&my_ao, MY_SIGNAL, NULL);
+ * \endcode
+ *
+ * Many state machines can then share the stack of a single task. Several
+ * executors can be created with different task priorities, so that urgent
+ * objects can preempt the long dispatch functions of the others.
+ */
+
+/* Configuration options ******************************************************/
+
+/*! \def CONFIG_OS_USE_ACTIVE
+ * \brief Use this option to enable the active objects support.
+ * \ingroup group_os_config
+ */
+#ifndef CONFIG_OS_USE_ACTIVE
+	#define CONFIG_OS_USE_ACTIVE false
+#endif
+
+/*! \def CONFIG_OS_ACTIVE_NB_PRIORITIES
+ * \brief Number of active object priority levels within an executor, up to
+ * 32. The level 0 is the highest priority.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_ACTIVE needs to be set
+ */
+#ifndef CONFIG_OS_ACTIVE_NB_PRIORITIES
+	#define CONFIG_OS_ACTIVE_NB_PRIORITIES 8
+#endif
+#if CONFIG_OS_ACTIVE_NB_PRIORITIES < 1 || CONFIG_OS_ACTIVE_NB_PRIORITIES > 32
+	#error CONFIG_OS_ACTIVE_NB_PRIORITIES must be between 1 and 32.
+#endif
+
+/* Types **********************************************************************/
+
+#if CONFIG_OS_USE_ACTIVE == true
+
+struct os_active;
+
+/*! \brief Message posted to an active object
+ */
+struct os_active_msg {
+	/*! \brief Signal, its meaning is defined by the application
+	 */
+	uint16_t signal;
+	/*! \brief Parameter of the message
+	 */
+	os_ptr_t data;
+};
+
+/*! \brief Dispatch function of an active object
+ * \param ao The active object
+ * \param msg The message to handle
+ */
+typedef void (*os_active_dispatch_t)(struct os_active *ao,
+		const struct os_active_msg *msg);
+
+/*! \brief Executor structure
+ */
+struct os_executor {
+	/*! \brief Task running the active objects
+	 */
+	struct os_task task;
+	/*! \brief First ready active object of each priority level
+	 */
+	struct os_active *first[CONFIG_OS_ACTIVE_NB_PRIORITIES];
+	/*! \brief Last ready active object of each priority level
+	 */
+	struct os_active *last[CONFIG_OS_ACTIVE_NB_PRIORITIES];
+	/*! \brief Bitmap of the priority levels which have a ready object
+	 */
+	uint32_t ready;
+};
+
+/*! \brief Active object structure
+ */
+struct os_active {
+	/*! \brief Executor running this object
+	 */
+	struct os_executor *executor;
+	/*! \brief Function handling the messages
+	 */
+	os_active_dispatch_t dispatch;
+	/*! \brief User data, to hold the state of the object for example
+	 */
+	os_ptr_t args;
+	/*! \brief Buffer of the message queue
+	 */
+	struct os_active_msg *buffer;
+	/*! \brief Size of the message queue
+	 */
+	uint8_t size;
+	/*! \brief Index of the first message in the queue
+	 */
+	uint8_t first;
+	/*! \brief Number of messages in the queue
+	 */
+	volatile uint8_t count;
+	/*! \brief Priority level of the object, 0 is the highest
+	 */
+	uint8_t priority;
+	/*! \brief Next ready object of the same priority level
+	 */
+	struct os_active *next;
+	/*! \brief Set while the object is in the ready list of its executor
+	 */
+	bool is_ready;
+};
+
+#endif
+
+/* Public API *****************************************************************/
+
+#if CONFIG_OS_USE_ACTIVE == true
+/*! \name Active Objects
+ *
+ * Set of functions to create and run active objects
+ *
+ * \{
+ */
+
+/*! \brief Create an executor. Its task is created the same way as
+ * \ref os_task_create does, the task priority can be changed afterwards with
+ * \ref os_task_set_priority.
+ * \ingroup group_os_public_api
+ * \param executor The un-initialized executor structure
+ * \param stack_size The size of the stack in byte. It must fit the deepest
+ * dispatch function of the objects it runs.
+ * \param options Options of the task (see \ref os_task_option)
+ * \return true if the executor has been correctly created, false otherwise.
+ * \pre \ref CONFIG_OS_USE_ACTIVE needs to be set
+ */
+bool os_executor_create(struct os_executor *executor, int stack_size,
+		enum os_task_option options);
+
+/*! \brief Create an active object
+ * \ingroup group_os_public_api
+ * \param ao The un-initialized active object structure
+ * \param executor The executor which will run the object
+ * \param dispatch The function handling the messages
+ * \param args User data, retrieved with \ref os_active_get_args
+ * \param buffer Array which holds the queued messages
+ * \param size Number of messages the buffer can hold
+ * \param priority The priority level, from 0 (the highest) to
+ * \ref CONFIG_OS_ACTIVE_NB_PRIORITIES - 1.
+ * \pre \ref CONFIG_OS_USE_ACTIVE needs to be set
+ */
+void os_active_create(struct os_active *ao, struct os_executor *executor,
+		os_active_dispatch_t dispatch, os_ptr_t args,
+		struct os_active_msg *buffer, uint8_t size, uint8_t priority);
+
+/*! \brief Post a message to an active object. This function does not block
+ * and can be called from an interrupt or from a dispatch function.
+ * \ingroup group_os_public_api
+ * \param ao The active object
+ * \param signal The signal of the message
+ * \param data The parameter of the message
+ * \return true if the message has been queued, false if the queue is full.
+ * \pre \ref CONFIG_OS_USE_ACTIVE needs to be set
+ */
+bool os_active_post(struct os_active *ao, uint16_t signal, os_ptr_t data);
+
+/*! \brief Get the user data of an active object
+ * \ingroup group_os_public_api
+ * \param ao The active object
+ * \return The user data given at the creation of the object
+ * \pre \ref CONFIG_OS_USE_ACTIVE needs to be set
+ */
+static inline os_ptr_t os_active_get_args(struct os_active *ao) {
+	return ao->args;
+}
+
+/*!
+ * \}
+ */
+#endif
+
+#endif // __OS_ACTIVE_H__
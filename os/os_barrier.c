@@ -0,0 +1,72 @@
+/*! \file
+ * \brief eeOS Barriers
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+bool os_barrier_wait(struct os_barrier *barrier)
+{
+	struct os_queue_process *elt;
+	bool is_last = false;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+#if CONFIG_OS_STATISTICS_MONITOR_BARRIER == true
+	os_time_t now = os_time_now();
+#endif
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+#if CONFIG_OS_STATISTICS_MONITOR_BARRIER == true
+	if (!barrier->arrived) {
+		barrier->first_arrival = now;
+	}
+#endif
+	/* The group is not complete yet, wait for the others */
+	if (++barrier->arrived < barrier->count) {
+		/* Queue element, it will be stored on the stack */
+		struct os_queue_process queue_elt;
+		/* Disable this process */
+		__os_process_disable_naked(__os_process_get_current());
+		/* Add this process to the waiting list of the barrier */
+		queue_elt.proc = __os_process_get_current();
+		os_queue_process_add(&barrier->queue, &queue_elt);
+		/* Manually switch the process context */
+		os_switch_context(false);
+	}
+	/* This is the last process, release the whole group */
+	else {
+#if CONFIG_OS_STATISTICS_MONITOR_BARRIER == true
+		barrier->phases++;
+		barrier->skew_last = now - barrier->first_arrival;
+		if (barrier->skew_last > barrier->skew_max) {
+			barrier->skew_max = barrier->skew_last;
+		}
+#endif
+		/* Wake up the waiters in the order of their priority */
+		for (elt = barrier->queue; elt; elt = elt->next) {
+			__os_process_enable_naked(elt->proc);
+		}
+		/* Ready for the next phase */
+		barrier->queue = NULL;
+		barrier->arrived = 0;
+		is_last = true;
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return is_last;
+}
@@ -0,0 +1,130 @@
+/*! \file
+ * \brief eeOS Barriers
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_BARRIER_H__
+#define __OS_BARRIER_H__
+
+/*! \addtogroup group_os
+ * \section section_os_barrier Barriers
+ *
+ * A barrier (\ref os_barrier) synchronizes a group of processes on phases:
+ * each process calls \ref os_barrier_wait at the end of a phase, and waits
+ * until all the processes of the group have done the same.
+ * \code
+ * os_barrier_create(&my_barrier, 4);
+ * // In each of the 4 tasks
+ * while (true) {
+ *	acquire_samples();
+ *	os_barrier_wait(&my_barrier);
+ * }
+ * \endcode
+ *
+ * The waiting processes are sorted by priority. The last process to arrive
+ * wakes them all up at once, within a single critical region, and the
+ * barrier is ready for the next phase straight away.
+ */
+
+/* Configuration options ******************************************************/
+
+/*! \def CONFIG_OS_STATISTICS_MONITOR_BARRIER
+ * \brief Measure the arrival skew of the barriers, which is the time between
+ * the first and the last process reaching a barrier during a phase. It is
+ * measured in nanoseconds with the monotonic time base (\ref os_time_now),
+ * so a phase can span several ticks.
+ * This enables the following functions:
+ * - \ref os_statistics_get_barrier_phases
+ * - \ref os_statistics_get_barrier_skew_last
+ * - \ref os_statistics_get_barrier_skew_max
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_TIME needs to be set
+ */
+#ifndef CONFIG_OS_STATISTICS_MONITOR_BARRIER
+	#define CONFIG_OS_STATISTICS_MONITOR_BARRIER false
+#endif
+#if CONFIG_OS_STATISTICS_MONITOR_BARRIER == true && \
+		CONFIG_OS_USE_TIME == false
+	#error CONFIG_OS_STATISTICS_MONITOR_BARRIER needs CONFIG_OS_USE_TIME.
+#endif
+
+/* Types **********************************************************************/
+
+/*! \brief Barrier structure
+ */
+struct os_barrier {
+	/*! \brief Number of processes of the group
+	 */
+	uint8_t count;
+	/*! \brief Number of processes which have reached the barrier during the
+	 * current phase
+	 */
+	uint8_t arrived;
+	/*! \brief Processes waiting on the barrier
+	 */
+	struct os_queue_process *queue;
+#if CONFIG_OS_STATISTICS_MONITOR_BARRIER == true
+	/*! \brief Number of phases completed
+	 */
+	uint32_t phases;
+	/*! \brief Time of the first arrival of the current phase
+	 */
+	os_time_t first_arrival;
+	/*! \brief Arrival skew of the last phase, in nanoseconds
+	 */
+	os_time_t skew_last;
+	/*! \brief Maximal arrival skew, in nanoseconds
+	 */
+	os_time_t skew_max;
+#endif
+};
+
+/* Public API *****************************************************************/
+
+/*! \name Barriers
+ *
+ * Set of functions to create and use barriers
+ *
+ * \{
+ */
+
+/*! \brief Creates a barrier
+ * \ingroup group_os_public_api
+ * \param barrier The un-initialized barrier structure
+ * \param count The number of processes of the group, from 1 to 255
+ */
+static inline void os_barrier_create(struct os_barrier *barrier,
+		uint8_t count) {
+	barrier->count = count;
+	barrier->arrived = 0;
+	barrier->queue = NULL;
+#if CONFIG_OS_STATISTICS_MONITOR_BARRIER == true
+	barrier->phases = 0;
+	barrier->skew_last = 0;
+	barrier->skew_max = 0;
+#endif
+}
+
+/*! \brief Wait until all the processes of the group reach the barrier
+ * \ingroup group_os_public_api
+ * \param barrier The barrier
+ * \return true for the last process to arrive, false for the others. This
+ * can be used to elect one process to run a step between 2 phases.
+ * \pre The barrier must have previously been created
+ */
+bool os_barrier_wait(struct os_barrier *barrier);
+
+/*!
+ * \}
+ */
+
+#endif // __OS_BARRIER_H__
@@ -0,0 +1,248 @@
+/*! \file
+ * \brief eeOS Publish/Subscribe Bus
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+#if CONFIG_OS_USE_BUS == true
+
+/*! \brief Drop a reference on a message, without calling its release
+ * function.
+ * \param msg The message
+ * \return true if this was the last reference, false otherwise.
+ * \warning This function must be called inside a critical section.
+ */
+static inline bool __os_bus_msg_put(struct os_bus_msg *msg) {
+	return (--msg->refs == 0);
+}
+
+/*! \brief Add a subscriber to a bus
+ * \param bus The bus
+ * \param sub The subscriber, already filled
+ */
+static void __os_bus_subscribe(struct os_bus *bus,
+		struct os_queue_bus_subscriber *sub)
+{
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	os_queue_bus_subscriber_insert_first(&bus->subscribers, sub);
+	bus->topics |= sub->filter;
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+enum os_event_status __os_event_bus_is_triggered(struct os_process *proc,
+		os_ptr_t args)
+{
+	struct os_queue_bus_subscriber *sub =
+			(struct os_queue_bus_subscriber *) args;
+
+	/* The message itself is read by the process once waken up */
+	return (sub->count) ? OS_EVENT_OK_STOP : OS_EVENT_NONE;
+}
+
+void os_bus_msg_ref(struct os_bus_msg *msg)
+{
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	msg->refs++;
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+void os_bus_msg_release(struct os_bus_msg *msg)
+{
+	bool is_last;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	is_last = __os_bus_msg_put(msg);
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+	/* Nobody holds the message anymore, give it back to its owner */
+	if (is_last && msg->release) {
+		msg->release(msg);
+	}
+}
+
+void os_bus_subscribe_handler(struct os_bus *bus,
+		struct os_queue_bus_subscriber *sub, uint32_t filter,
+		os_bus_handler_t handler, os_ptr_t args)
+{
+	sub->filter = filter;
+	sub->handler = handler;
+	sub->args = args;
+	sub->buffer = NULL;
+	sub->size = 0;
+	sub->first = 0;
+	sub->count = 0;
+	__os_bus_subscribe(bus, sub);
+}
+
+void os_bus_subscribe_mailbox(struct os_bus *bus,
+		struct os_queue_bus_subscriber *sub, uint32_t filter,
+		struct os_bus_msg **buffer, uint8_t size)
+{
+	/* Event descriptor for the mailbox */
+	const struct os_event_descriptor mailbox_event_descriptor = {
+		.is_triggered = __os_event_bus_is_triggered
+	};
+
+	sub->filter = filter;
+	sub->handler = NULL;
+	sub->args = NULL;
+	sub->buffer = buffer;
+	sub->size = size;
+	sub->first = 0;
+	sub->count = 0;
+	__os_event_create(&sub->event, &mailbox_event_descriptor,
+			(os_ptr_t) sub);
+	__os_bus_subscribe(bus, sub);
+}
+
+void os_bus_unsubscribe(struct os_bus *bus,
+		struct os_queue_bus_subscriber *sub)
+{
+	struct os_queue_bus_subscriber *elt;
+	struct os_bus_msg *msg;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	os_queue_bus_subscriber_remove(&bus->subscribers, sub);
+	/* Rebuild the bitmap of the subscribed topics */
+	bus->topics = 0;
+	for (elt = bus->subscribers; elt; elt = elt->next) {
+		bus->topics |= elt->filter;
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+	/* Release the messages left in the mailbox */
+	while ((msg = os_bus_try_receive(sub)) != NULL) {
+		os_bus_msg_release(msg);
+	}
+}
+
+int os_bus_publish(struct os_bus *bus, uint8_t topic, struct os_bus_msg *msg)
+{
+	struct os_queue_bus_subscriber *sub;
+	uint32_t mask = 1UL << topic;
+	int nb_deliveries = 0;
+	bool is_last;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	msg->topic = topic;
+	/* The publisher holds a reference during the delivery, so that a
+	 * handler releasing the message does not free it too early.
+	 */
+	msg->refs++;
+	/* Skip the subscribers if nobody listens to this topic */
+	if (bus->topics & mask) {
+		for (sub = bus->subscribers; sub; sub = sub->next) {
+			if (!(sub->filter & mask)) {
+				continue;
+			}
+			if (sub->handler) {
+				sub->handler(msg, sub->args);
+			}
+			/* Drop the message if the mailbox is full */
+			else if (sub->count < sub->size) {
+				sub->buffer[(sub->first + sub->count) % sub->size] = msg;
+				sub->count++;
+				msg->refs++;
+			}
+			else {
+				continue;
+			}
+			nb_deliveries++;
+		}
+	}
+	is_last = __os_bus_msg_put(msg);
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+	/* Nobody kept the message */
+	if (is_last && msg->release) {
+		msg->release(msg);
+	}
+
+	return nb_deliveries;
+}
+
+struct os_bus_msg *os_bus_try_receive(struct os_queue_bus_subscriber *sub)
+{
+	struct os_bus_msg *msg = NULL;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	if (sub->count) {
+		msg = sub->buffer[sub->first];
+		sub->first = (sub->first + 1) % sub->size;
+		sub->count--;
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return msg;
+}
+
+struct os_bus_msg *os_bus_receive(struct os_queue_bus_subscriber *sub)
+{
+	struct os_bus_msg *msg;
+
+	/* Sleep until the mailbox gets a message */
+	while ((msg = os_bus_try_receive(sub)) == NULL) {
+		os_task_sleep(&sub->event);
+	}
+
+	return msg;
+}
+
+#endif
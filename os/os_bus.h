@@ -0,0 +1,294 @@
+/*! \file
+ * \brief eeOS Publish/Subscribe Bus
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_BUS_H__
+#define __OS_BUS_H__
+
+/*! \addtogroup group_os
+ * \section section_os_bus Publish/Subscribe Bus
+ *
+ * A bus (\ref os_bus) delivers messages (\ref os_bus_msg) posted to a topic to
+ * all the subscribers (\ref os_queue_bus_subscriber) which filter includes
+ * this topic. A bus has up to 32 topics, identified by their number (0 to 31),
+ * and a filter is a mask of topics.
+ *
+ * A subscriber is either:
+ * - A handler (\ref os_bus_subscribe_handler), called directly by the
+ *   publisher.
+ * - A mailbox (\ref os_bus_subscribe_mailbox), holding the messages until a
+ *   process reads them (\ref os_bus_receive). The mailbox comes with an event
+ *   (\ref os_bus_get_event), so a task can also wait for it among other events
+ *   (\ref os_task_sleep).
+ *
+ * \code
+ * struct my_msg {
+ *	struct os_bus_msg msg;
+ *	int value;
+ * } my_msg;
+ * os_bus_msg_create(&my_msg.msg, NULL);
+ * my_msg.value = 42;
+ * os_bus_publish(&my_bus, MY_TOPIC, &my_msg.msg);
+ * \endcode
+ *
+ * The messages are not copied: the subscribers get a pointer on the message
+ * published. A message is reference counted, each mailbox holding it owns a
+ * reference until \ref os_bus_msg_release is called. When the last reference
+ * is released, the release function of the message is called, to give the
+ * message back to its pool for example.
+ *
+ * The bus keeps a bitmap of the topics which have at least one subscriber,
+ * a message posted to a topic without subscriber is dropped in constant time.
+ */
+
+/* Configuration options ******************************************************/
+
+/*! \def CONFIG_OS_USE_BUS
+ * \brief Use this option to enable the publish/subscribe bus support.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_EVENTS needs to be set
+ */
+#ifndef CONFIG_OS_USE_BUS
+	#define CONFIG_OS_USE_BUS false
+#endif
+#if CONFIG_OS_USE_BUS == true && CONFIG_OS_USE_EVENTS == false
+	#error The bus mailboxes rely on the events. CONFIG_OS_USE_EVENTS must be\
+			set.
+#endif
+
+/* Types **********************************************************************/
+
+#if CONFIG_OS_USE_BUS == true
+
+struct os_bus_msg;
+
+/*! \brief Function called when the last reference on a message is released
+ * \param msg The message
+ */
+typedef void (*os_bus_release_t)(struct os_bus_msg *msg);
+
+/*! \brief Subscriber handler
+ * \param msg The message published. The handler must take a reference
+ * (\ref os_bus_msg_ref) to keep it once it returns.
+ * \param args Arguments given when the handler has subscribed
+ */
+typedef void (*os_bus_handler_t)(struct os_bus_msg *msg, os_ptr_t args);
+
+/*! \brief Header of a bus message. It must be embedded in the user message.
+ */
+struct os_bus_msg {
+	/*! \brief Number of references on the message
+	 */
+	volatile uint8_t refs;
+	/*! \brief Topic the message has been published to
+	 */
+	uint8_t topic;
+	/*! \brief Function called when the last reference is released, can be
+	 * NULL.
+	 */
+	os_bus_release_t release;
+};
+
+/*! \struct os_queue_bus_subscriber
+ * \brief Subscriber of a bus (see \ref OS_QUEUE_DEFINE for more details)
+ */
+OS_QUEUE_DEFINE(bus_subscriber,
+	/*! \brief Topics the subscriber is interested in, one bit per topic */
+	uint32_t filter;
+	/*! \brief Handler called on each message, NULL for a mailbox */
+	os_bus_handler_t handler;
+	/*! \brief Arguments of the handler */
+	os_ptr_t args;
+	/*! \brief Buffer of the mailbox */
+	struct os_bus_msg **buffer;
+	/*! \brief Size of the mailbox buffer */
+	uint8_t size;
+	/*! \brief Index of the first message in the mailbox */
+	uint8_t first;
+	/*! \brief Number of messages in the mailbox */
+	volatile uint8_t count;
+	/*! \brief Event triggered while the mailbox is not empty */
+	struct os_event event;
+);
+
+/*! \brief Bus structure
+ */
+struct os_bus {
+	/*! \brief Bitmap of the topics which have at least one subscriber
+	 */
+	uint32_t topics;
+	/*! \brief List of the subscribers
+	 */
+	struct os_queue_bus_subscriber *subscribers;
+};
+
+#endif
+
+/* Internal API ***************************************************************/
+
+#if CONFIG_OS_USE_BUS == true
+/*! \brief Event handler of a mailbox
+ * \ingroup group_os_internal_api
+ */
+enum os_event_status __os_event_bus_is_triggered(struct os_process *proc,
+		os_ptr_t args);
+#endif
+
+/* Public API *****************************************************************/
+
+#if CONFIG_OS_USE_BUS == true
+/*! \name Publish/Subscribe Bus
+ *
+ * Set of functions to publish and receive messages through a bus
+ *
+ * \{
+ */
+
+/*! \brief Creates a bus
+ * \ingroup group_os_public_api
+ * \param bus The un-initialized bus structure
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+static inline void os_bus_create(struct os_bus *bus) {
+	bus->topics = 0;
+	bus->subscribers = NULL;
+}
+
+/*! \brief Initialize the header of a message
+ * \ingroup group_os_public_api
+ * \param msg The message
+ * \param release Function called when the last reference on the message is
+ * released, or NULL.
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+static inline void os_bus_msg_create(struct os_bus_msg *msg,
+		os_bus_release_t release) {
+	msg->refs = 0;
+	msg->topic = 0;
+	msg->release = release;
+}
+
+/*! \brief Take a reference on a message
+ * \ingroup group_os_public_api
+ * \param msg The message
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+void os_bus_msg_ref(struct os_bus_msg *msg);
+
+/*! \brief Release a reference on a message. The release function of the
+ * message is called if this was the last reference.
+ * \ingroup group_os_public_api
+ * \param msg The message
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+void os_bus_msg_release(struct os_bus_msg *msg);
+
+/*! \brief Get the topic a message has been published to
+ * \ingroup group_os_public_api
+ * \param msg The message
+ * \return The topic
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+static inline uint8_t os_bus_msg_get_topic(struct os_bus_msg *msg) {
+	return msg->topic;
+}
+
+/*! \brief Subscribe a handler to a bus
+ * \ingroup group_os_public_api
+ * \param bus The bus
+ * \param sub The un-initialized subscriber structure
+ * \param filter Mask of the topics to receive (bit n for the topic n)
+ * \param handler The function called on each message. It is called by the
+ * publisher within a critical region, so it must be short and must not
+ * block.
+ * \param args Arguments passed to the handler
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+void os_bus_subscribe_handler(struct os_bus *bus,
+		struct os_queue_bus_subscriber *sub, uint32_t filter,
+		os_bus_handler_t handler, os_ptr_t args);
+
+/*! \brief Subscribe a mailbox to a bus
+ * \ingroup group_os_public_api
+ * \param bus The bus
+ * \param sub The un-initialized subscriber structure
+ * \param filter Mask of the topics to receive (bit n for the topic n)
+ * \param buffer Array which holds the messages of the mailbox
+ * \param size Number of messages the buffer can hold. A message published
+ * while the mailbox is full is not delivered to it.
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+void os_bus_subscribe_mailbox(struct os_bus *bus,
+		struct os_queue_bus_subscriber *sub, uint32_t filter,
+		struct os_bus_msg **buffer, uint8_t size);
+
+/*! \brief Remove a subscriber from a bus. The messages left in its mailbox
+ * are released.
+ * \ingroup group_os_public_api
+ * \param bus The bus
+ * \param sub The subscriber
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+void os_bus_unsubscribe(struct os_bus *bus,
+		struct os_queue_bus_subscriber *sub);
+
+/*! \brief Publish a message to a topic. This function can be called from an
+ * interrupt.
+ * \ingroup group_os_public_api
+ * \param bus The bus
+ * \param topic The topic, from 0 to 31
+ * \param msg The message. If no subscriber keeps it, it is released before
+ * this function returns.
+ * \return The number of subscribers the message has been delivered to.
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+int os_bus_publish(struct os_bus *bus, uint8_t topic, struct os_bus_msg *msg);
+
+/*! \brief Get the next message of a mailbox, without waiting
+ * \ingroup group_os_public_api
+ * \param sub The mailbox subscriber
+ * \return The message, or NULL if the mailbox is empty. The caller owns a
+ * reference on the message, it must release it with
+ * \ref os_bus_msg_release.
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+struct os_bus_msg *os_bus_try_receive(struct os_queue_bus_subscriber *sub);
+
+/*! \brief Get the next message of a mailbox. The current task sleeps until
+ * a message is available.
+ * \ingroup group_os_public_api
+ * \param sub The mailbox subscriber
+ * \return The message. The caller owns a reference on the message, it must
+ * release it with \ref os_bus_msg_release.
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+struct os_bus_msg *os_bus_receive(struct os_queue_bus_subscriber *sub);
+
+/*! \brief Get the event of a mailbox. It triggers while the mailbox is not
+ * empty.
+ * \ingroup group_os_public_api
+ * \param sub The mailbox subscriber
+ * \return The event
+ * \pre \ref CONFIG_OS_USE_BUS needs to be set
+ */
+static inline struct os_event *os_bus_get_event(
+		struct os_queue_bus_subscriber *sub) {
+	return &sub->event;
+}
+
+/*!
+ * \}
+ */
+#endif
+
+#endif // __OS_BUS_H__
@@ -0,0 +1,117 @@
+/*! \file
+ * \brief eeOS Condition Variables
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+/*! \brief Move waiters from a condition variable to the waiting list of its
+ * mutex. If the mutex is free, it is given to the first waiter, which is
+ * enabled.
+ * \param cond The condition variable, at least one process must wait on it
+ * \param is_broadcast Move all the waiters if set, only the first one
+ * otherwise
+ * \warning This function must be called inside a critical section.
+ */
+static void __os_cond_morph(struct os_cond *cond, bool is_broadcast)
+{
+	struct os_mutex *mutex = cond->mutex;
+	struct os_wait_queue_elt *elt;
+	struct os_process *proc;
+
+	/* Move the waiters in the order of their priority, each one in
+	 * constant time. The processes already waiting for the mutex go first
+	 * among equals.
+	 */
+	do {
+		elt = os_wait_queue_pop(&cond->queue);
+		os_wait_queue_add(&mutex->queue, elt, elt->proc);
+	} while (is_broadcast && !os_wait_queue_is_empty(&cond->queue));
+	/* If the mutex is free, lock it for the first waiter */
+	if (!__os_mutex_is_locked(mutex)) {
+		proc = os_wait_queue_pop(&mutex->queue)->proc;
+		__os_mutex_acquire(mutex, proc);
+		__os_process_enable_naked(proc);
+	}
+	/* Else its owner must now wake up the waiters when unlocking it */
+	else {
+		mutex->state |= __OS_MUTEX_WAITERS;
+	}
+}
+
+void os_cond_wait(struct os_cond *cond, struct os_mutex *mutex)
+{
+	/* Create a queue element, it will be stored on the stack. It is moved
+	 * to the waiting list of the mutex when the process is waken up.
+	 */
+	struct os_wait_queue_elt queue_elt;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	cond->mutex = mutex;
+	/* Disable this process */
+	__os_process_disable_naked(__os_process_get_current());
+	/* Add this process to the waiting list of the condition variable */
+	os_wait_queue_add(&cond->queue, &queue_elt, __os_process_get_current());
+	/* Release the mutex, it can be given to another process */
+	os_mutex_unlock(mutex);
+	/* Manually switch the process context. The mutex is owned by this
+	 * process again when it resumes.
+	 */
+	os_switch_context(false);
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+void os_cond_signal(struct os_cond *cond)
+{
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Move the first waiter to the mutex */
+	if (!os_wait_queue_is_empty(&cond->queue)) {
+		__os_cond_morph(cond, false);
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+void os_cond_broadcast(struct os_cond *cond)
+{
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Move all the waiters to the mutex at once */
+	if (!os_wait_queue_is_empty(&cond->queue)) {
+		__os_cond_morph(cond, true);
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
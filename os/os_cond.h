@@ -0,0 +1,105 @@
+/*! \file
+ * \brief eeOS Condition Variables
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_COND_H__
+#define __OS_COND_H__
+
+/*! \addtogroup group_os
+ * \section section_os_cond Condition Variables
+ *
+ * A condition variable (\ref os_cond) lets processes wait, with a mutex
+ * locked, until a shared state changes.
+ * \code
+ * os_mutex_lock(&my_mutex);
+ * while (!my_state_changed) {
+ *	os_cond_wait(&my_cond, &my_mutex);
+ * }
+ * os_mutex_unlock(&my_mutex);
+ * \endcode
+ * And to notify the change:
+ * \code
+ * os_mutex_lock(&my_mutex);
+ * my_state_changed = true;
+ * os_cond_broadcast(&my_cond);
+ * os_mutex_unlock(&my_mutex);
+ * \endcode
+ *
+ * Waking up a process does not make it runnable straight away: the process
+ * must get the mutex back first. Its waiting record is moved from the queue
+ * of the condition variable to the queue of the mutex (wait morphing), so
+ * that it will be waken up by the mutex itself. \ref os_cond_broadcast moves
+ * all the waiters into the queue of the mutex at once, only the one getting
+ * the mutex is enabled.
+ */
+
+/* Types **********************************************************************/
+
+/*! \brief Condition variable structure
+ */
+struct os_cond {
+	/*! \brief The mutex used by the waiting processes
+	 */
+	struct os_mutex *mutex;
+	/*! \brief Processes waiting on the condition variable
+	 */
+	struct os_wait_queue queue;
+};
+
+/* Public API *****************************************************************/
+
+/*! \name Condition Variables
+ *
+ * Set of functions to create and control condition variables
+ *
+ * \{
+ */
+
+/*! \brief Creates a condition variable
+ * \ingroup group_os_public_api
+ * \param cond The un-initialized condition variable structure
+ */
+static inline void os_cond_create(struct os_cond *cond) {
+	cond->mutex = NULL;
+	os_wait_queue_init(&cond->queue);
+}
+
+/*! \brief Unlock a mutex and wait on a condition variable, atomically. The
+ * mutex is locked again when this function returns.
+ * \ingroup group_os_public_api
+ * \param cond The condition variable
+ * \param mutex The mutex, locked by the current process. All the processes
+ * waiting at the same time on a condition variable must use the same mutex.
+ * \pre The condition variable and the mutex must have previously been created
+ */
+void os_cond_wait(struct os_cond *cond, struct os_mutex *mutex);
+
+/*! \brief Wake up the first process waiting on a condition variable
+ * \ingroup group_os_public_api
+ * \param cond The condition variable
+ * \pre The condition variable must have previously been created
+ */
+void os_cond_signal(struct os_cond *cond);
+
+/*! \brief Wake up all the processes waiting on a condition variable
+ * \ingroup group_os_public_api
+ * \param cond The condition variable
+ * \pre The condition variable must have previously been created
+ */
+void os_cond_broadcast(struct os_cond *cond);
+
+/*!
+ * \}
+ */
+
+#endif // __OS_COND_H__
@@ -26,21 +26,22 @@
  */
 
 /*! \brief Context of the application task. This contex is initially filled
- * as an active task with the highest priority. This task is shared with the
- * event task, therefore changing the priority of the event task will change
- * the priority of this task as well.
+ * as an active task with the highest priority.
  * \note This context is available only after the call of \ref os_start
  */
 struct os_process os_app = {
 	.next = &os_app,
 	.status = OS_PROCESS_ACTIVE,
 	.type = OS_PROCESS_TYPE_APPLICATION,
+	.flags = OS_PROCESS_FLAG_NONE,
 #if CONFIG_OS_USE_PRIORITY == true
 	.priority = OS_PRIORITY_1,
 	.priority_counter = OS_PRIORITY_1,
 #endif
 #if CONFIG_OS_STATISTICS_MONITOR_TASK_SWITCH == true
 	.cycle_counter = 0,
+	.voluntary_switch_counter = 0,
+	.involuntary_switch_counter = 0,
 #endif
 };
 
@@ -56,6 +57,49 @@ struct os_process *__os_current_process = &os_app;
 volatile os_tick_t os_tick_counter = 0;
 #endif
 
+#if CONFIG_OS_USE_TICK_RATE == true
+/*! \brief Number of ticks elapsed at each tick interrupt.
+ */
+volatile os_tick_t __os_tick_step = 1;
+
+/*! \brief Number of ticks per tick interrupt requested by
+ * \ref os_set_tick_rate, 0 if no change is pending.
+ */
+static volatile os_tick_t __os_tick_step_pending = 0;
+
+bool os_set_tick_rate(uint32_t hz)
+{
+	/* The rate must be a divider of the base tick rate */
+	if (!hz || hz > CONFIG_OS_TICK_HZ || (CONFIG_OS_TICK_HZ % hz)) {
+		return false;
+	}
+	__os_tick_step_pending = CONFIG_OS_TICK_HZ / hz;
+	return true;
+}
+
+void __os_tick_rate_update(void)
+{
+	extern void os_setup_tick_rate(uint32_t);
+
+	if (__os_tick_step_pending) {
+		__os_tick_step = __os_tick_step_pending;
+		__os_tick_step_pending = 0;
+		/* Re-program the tick timer, right after the interrupt */
+		os_setup_tick_rate(CONFIG_OS_TICK_HZ / __os_tick_step);
+	}
+}
+#endif
+
+struct os_process *__os_switch_context_next(void)
+{
+	return __os_switch_context_hook();
+}
+
+struct os_process *__os_switch_context_int_handler_next(void)
+{
+	return __os_switch_context_int_handler_hook();
+}
+
 #if CONFIG_OS_USE_PRIORITY == true
 struct os_process *__os_scheduler(void)
 {
@@ -203,11 +247,6 @@ void __os_process_disable_naked(struct os_process *proc)
 	if (last_proc == proc) {
 		/* Loop the application process over itslef. */
 		os_app.next = &os_app;
-		/* Set this process as the application process. This is
-		 * necessary since this process is shared with the event
-		 * process.
-		 */
-		os_app.type = OS_PROCESS_TYPE_APPLICATION;
 		/* Change the application process to active */
 		os_app.status = OS_PROCESS_ACTIVE;
 		/* Insert the application process in the active process list
@@ -99,10 +99,11 @@
  * carefully chosen. The application stack is used by different modules in the
  * operating system:
  * - \ref section_os_process_interrupt will runs within the application context.
- * - The \ref section_os_event scheduler will run within the application
- * context.
  * - Everything you put in \ref HOOK_OS_IDLE will also run within the
  * application context.
+ *
+ * The \ref section_os_event scheduler runs within its own process and uses its
+ * own stack, its size is set by \ref CONFIG_OS_EVENT_STACK_SIZE.
  */
 
 /*! \defgroup group_os_public_api Public API
@@ -180,6 +181,8 @@
  * (\ref os_scheduler_type).
  *
  * This operating system can use cooperative and pre-emptive tasks together.
+ * A task is made cooperative with the \ref OS_TASK_COOPERATIVE option, it
+ * will then never be preempted by the tick interrupt.
  * To allow \b only cooperative tasks, set the value to
  * \ref CONFIG_OS_SCHEDULER_COOPERATIVE.
  * \ingroup group_os_config
@@ -213,6 +216,21 @@
 	#define CONFIG_OS_TICK_HZ 1000
 #endif
 
+/*! \def CONFIG_OS_USE_TICK_RATE
+ * \brief Set this config to \b true to change the tick rate at runtime with
+ * \ref os_set_tick_rate. \ref CONFIG_OS_TICK_HZ is then the highest rate, and
+ * remains the unit of all the tick counts (\ref os_tick_t).
+ * \ingroup group_os_config
+ */
+#ifndef CONFIG_OS_USE_TICK_RATE
+	#define CONFIG_OS_USE_TICK_RATE false
+#endif
+#if CONFIG_OS_USE_TICK_RATE == true && \
+		CONFIG_OS_SCHEDULER_TYPE == CONFIG_OS_SCHEDULER_COOPERATIVE
+	#error The tick rate cannot be changed when only cooperative scheduler\
+			is used.
+#endif
+
 /*! \def CONFIG_OS_USE_PRIORITY
  * \brief Set this config to \b true in order to enable task priority support.
  * \ingroup group_os_config
@@ -264,6 +282,16 @@
 	#define CONFIG_OS_PROCESS_ENABLE_FIFO false
 #endif
 
+/*! \def CONFIG_OS_USE_ATOMIC
+ * \brief Use the atomic operations of the port (\ref os_atomic_cas) to lock
+ * and unlock the mutexes, and to take and release the semaphores, without
+ * masking the interrupts when no process has to wait or to be waken up.
+ * \ingroup group_os_config
+ */
+#ifndef CONFIG_OS_USE_ATOMIC
+	#define CONFIG_OS_USE_ATOMIC false
+#endif
+
 /*!
  * \}
  */
@@ -402,6 +430,9 @@ enum os_process_type {
 	/*! \brief Event scheduler
 	 */
 	OS_PROCESS_TYPE_EVENT = 3,
+	/*! \brief Timer daemon (\ref section_os_timer)
+	 */
+	OS_PROCESS_TYPE_TIMER = 4,
 };
 
 /*! \brief Status of the process
@@ -422,6 +453,18 @@ enum os_process_status {
 	OS_PROCESS_PENDING = 2,
 };
 
+/*! \brief Flags of a process
+ */
+enum os_process_flag {
+	/*! \brief No specific flag
+	 */
+	OS_PROCESS_FLAG_NONE = 0,
+	/*! \brief The process is cooperative. It will never be preempted by the
+	 * tick interrupt and will run until it releases the CPU by itself.
+	 */
+	OS_PROCESS_FLAG_COOPERATIVE = 1,
+};
+
 /*! \brief This structure represents a process context
  */
 struct os_process {
@@ -441,6 +484,10 @@ struct os_process {
 	 * Values are part of \ref os_process_type
 	 */
 	uint8_t type;
+	/*! \brief Process flags
+	 * Values are part of \ref os_process_flag
+	 */
+	uint8_t flags;
 #if CONFIG_OS_USE_PRIORITY == true
 	/*! \brief Priority of the process.
 	 * Values are part of \ref os_priority
@@ -457,6 +504,14 @@ struct os_process {
 	 * during context switches.
 	 */
 	os_cy_t cycle_counter;
+	/*! \brief Number of times the process released the CPU by itself.
+	 * It is used for statistics only.
+	 */
+	uint32_t voluntary_switch_counter;
+	/*! \brief Number of times the process has been preempted by the tick
+	 * interrupt. It is used for statistics only.
+	 */
+	uint32_t involuntary_switch_counter;
 #endif
 };
 
@@ -607,6 +662,32 @@ static inline bool __os_process_is_event(struct os_process *proc) {
 #endif
 }
 
+/*! \brief Check if a process is cooperative
+ * \ingroup group_os_internal_api
+ * \param proc The process to be checked
+ * \return true if the process cannot be preempted by the tick interrupt, false
+ * otherwise
+ */
+static inline bool __os_process_is_cooperative(struct os_process *proc) {
+	return (bool) (proc->flags & OS_PROCESS_FLAG_COOPERATIVE);
+}
+
+/*! \brief Set or clear the cooperative flag of a process
+ * \ingroup group_os_internal_api
+ * \param proc The process to be updated
+ * \param is_cooperative true to make the process cooperative, false to make it
+ * preemptive
+ */
+static inline void __os_process_set_cooperative(struct os_process *proc,
+		bool is_cooperative) {
+	if (is_cooperative) {
+		proc->flags |= OS_PROCESS_FLAG_COOPERATIVE;
+	}
+	else {
+		proc->flags &= ~OS_PROCESS_FLAG_COOPERATIVE;
+	}
+}
+
 /*! \brief Enable the execution a process
  * \ingroup group_os_internal_api
  * \param proc The process to be enabled
@@ -673,6 +754,10 @@ struct os_process *__os_scheduler(void);
  * \return The context of the new process
  */
 static inline struct os_process *__os_switch_context_hook(void) {
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_SWITCH == true
+	struct os_process *last_proc = __os_process_get_current();
+	struct os_process *proc;
+#endif
 #ifdef OS_SCHEDULER_POST_INTERRUPT_HOOK
 	/* Clear the software interrupt if needed */
 	OS_SCHEDULER_POST_INTERRUPT_HOOK();
@@ -681,10 +766,30 @@ static inline struct os_process *__os_switch_context_hook(void) {
 	/* Use the alternate task if any */
 	OS_SCHEDULER_POST_EVENT_HOOK();
 #endif
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_SWITCH == true
+	/* Task switch context */
+	proc = __os_scheduler();
+	/* The process released the CPU by itself */
+	if (proc != last_proc) {
+		last_proc->voluntary_switch_counter++;
+	}
+	return proc;
+#else
 	/* Task switch context */
 	return __os_scheduler();
+#endif
 }
 
+/*! \brief Out-of-line call of \ref __os_switch_context_hook, to be used by
+ * the ports.
+ * \ingroup group_os_internal_api
+ * The hook is inlined and may run code after the scheduler, so the register
+ * holding its result is not known. The ports must use the value returned by
+ * this function instead, which follows the calling convention.
+ * \return The context of the new process
+ */
+struct os_process *__os_switch_context_next(void);
+
 /*! \brief Initializes a process
  * \ingroup group_os_internal_api
  * \param proc The process to be initialized
@@ -699,9 +804,14 @@ static inline void __os_process_create(struct os_process *proc, os_ptr_t sp,
 	proc->type = type;
 	/* Set the status of the process. Initially it is set to idle. */
 	proc->status = OS_PROCESS_IDLE;
+	/* By default a process is preemptive */
+	proc->flags = OS_PROCESS_FLAG_NONE;
 #if CONFIG_OS_STATISTICS_MONITOR_TASK_SWITCH == true
 	/* Update the activity cycle counter of this task. */
 	proc->cycle_counter = 0;
+	/* Reset the context switch counters */
+	proc->voluntary_switch_counter = 0;
+	proc->involuntary_switch_counter = 0;
 #endif
 }
 
@@ -719,37 +829,13 @@ static inline struct os_process *__os_process_get_application(void) {
 static inline void __os_process_application_enable(void) {
 	extern struct os_process os_app;
 	__os_process_enable(&os_app);
-	os_app.type = OS_PROCESS_TYPE_APPLICATION;
 }
 /*! \brief Disable the application process
  * \ingroup group_os_internal_api
  */
 static inline void __os_process_application_disable(void) {
 	extern struct os_process os_app;
-	if (__os_process_is_application(&os_app)) {
-		__os_process_disable(&os_app);
-	}
-}
-/*! \brief Enable the event process
- * If the event process is enabled, the application process will be disabled
- * as they share the same process.
- * \ingroup group_os_internal_api
- */
-static inline void __os_process_event_enable(void) {
-	extern struct os_process os_app;
-	__os_process_application_enable();
-	os_app.type = OS_PROCESS_TYPE_EVENT;
-}
-/*! \brief Enable the event process
- * If the event process is enabled, the application process will be disabled
- * as they share the same process.
- * \ingroup group_os_internal_api
- */
-static inline void __os_process_event_disable(void) {
-	extern struct os_process os_app;
-	if (__os_process_is_event(&os_app)) {
-		__os_process_disable(&os_app);
-	}
+	__os_process_disable(&os_app);
 }
 
 /*! \copydoc __os_process_enable
@@ -767,12 +853,37 @@ void __os_process_enable_naked(struct os_process *proc);
  */
 void __os_process_disable_naked(struct os_process *proc);
 
+#if CONFIG_OS_USE_TICK_RATE == true
+/*! \brief Get the number of ticks elapsed at each tick interrupt
+ * \ingroup group_os_internal_api
+ * \return The number of ticks per tick interrupt
+ */
+static inline os_tick_t __os_tick_get_step(void) {
+	extern volatile os_tick_t __os_tick_step;
+	return __os_tick_step;
+}
+/*! \brief Apply the tick rate requested by \ref os_set_tick_rate, if any.
+ * \ingroup group_os_internal_api
+ * \warning This function must be called from the tick interrupt.
+ */
+void __os_tick_rate_update(void);
+#else
+static inline os_tick_t __os_tick_get_step(void) {
+	return 1;
+}
+#endif
+
 /* Includes (which will impact the core) **************************************/
 
 #include "os_debug.h"
 #include "os_queue.h"
 #include "os_event.h"
+#include "os_time.h"
+#include "os_schedulability.h"
 #include "os_task.h"
+#include "os_cyclic.h"
+#include "os_timer.h"
+#include "os_hrtimer.h"
 
 /* Internal API (impacted by the previous modules) ****************************/
 
@@ -783,19 +894,69 @@ void __os_process_disable_naked(struct os_process *proc);
  * \return The context of the new process
  */
 static inline struct os_process *__os_switch_context_int_handler_hook(void) {
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_SWITCH == true
+	struct os_process *last_proc = __os_process_get_current();
+	struct os_process *proc;
+#endif
+#if CONFIG_OS_USE_TICK_COUNTER == true
+	/* Number of ticks elapsed since the previous tick interrupt */
+	os_tick_t step = __os_tick_get_step();
+#endif
+#if CONFIG_OS_USE_HRTIMER == true
+	/* The interrupt is shared with the high-resolution timers, return to
+	 * the interrupted process if it is not a tick.
+	 */
+	if (!__os_hrtimer_int_handler()) {
+		return __os_process_get_current();
+	}
+#endif
+#if CONFIG_OS_USE_TICK_RATE == true
+	/* The new tick rate applies from this interrupt on */
+	__os_tick_rate_update();
+#endif
+	/* Update the time base */
+	__HOOK_OS_TIME_TICK();
 #if CONFIG_OS_USE_TICK_COUNTER == true
 	extern volatile os_tick_t os_tick_counter;
 	/* Update the tick counter */
-	os_tick_counter++;
+	os_tick_counter += step;
+	/* Advance the software timers */
+	__HOOK_OS_TIMER_TICK();
 #endif
 #if CONFIG_OS_DEBUG == true
 	__HOOK_OS_DEBUG_TICK();
 #endif
 	HOOK_OS_TICK();
+	/* A cooperative process is never preempted by the tick interrupt, it
+	 * keeps the CPU until it releases it by itself.
+	 */
+	if (__os_process_is_cooperative(__os_process_get_current())) {
+		return __os_process_get_current();
+	}
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_SWITCH == true
+	/* Task switch context */
+	proc = __os_scheduler();
+	/* The previous process has been preempted */
+	if (proc != last_proc) {
+		last_proc->involuntary_switch_counter++;
+	}
+	return proc;
+#else
 	/* Task switch context */
 	return __os_scheduler();
+#endif
 }
 
+/*! \brief Out-of-line call of \ref __os_switch_context_int_handler_hook, to
+ * be used by the ports.
+ * \ingroup group_os_internal_api
+ * The hook is inlined and may return without calling the scheduler, so the
+ * register holding its result is not known. The ports must use the value
+ * returned by this function instead, which follows the calling convention.
+ * \return The context of the new process
+ */
+struct os_process *__os_switch_context_int_handler_next(void);
+
 /* Public API *****************************************************************/
 
 /*! \name Kernel Control
@@ -811,6 +972,44 @@ static inline struct os_process *__os_switch_context_int_handler_hook(void) {
  */
 void os_yield(void);
 
+#if CONFIG_OS_USE_TICK_RATE == true
+/*! \brief Change the tick rate. The change is applied on the next tick
+ * interrupt.
+ *
+ * The ticks keep the same unit (1 / \ref CONFIG_OS_TICK_HZ), each tick
+ * interrupt advances the tick counter by \ref CONFIG_OS_TICK_HZ / \b hz ticks.
+ * Therefore the pending delays and timeouts, as well as
+ * \ref OS_MS_TO_TICKS, remain valid across changes, only their granularity
+ * becomes the tick interrupt period.
+ * \ingroup group_os_public_api
+ * \param hz The new tick rate in Hz. It must divide \ref CONFIG_OS_TICK_HZ.
+ * \return true if the rate is valid, false otherwise.
+ * \pre \ref CONFIG_OS_USE_TICK_RATE needs to be set first.
+ */
+bool os_set_tick_rate(uint32_t hz);
+
+/*! \brief Get the current tick rate
+ * \ingroup group_os_public_api
+ * \return The tick rate in Hz
+ * \pre \ref CONFIG_OS_USE_TICK_RATE needs to be set first.
+ */
+static inline uint32_t os_get_tick_rate(void) {
+	return CONFIG_OS_TICK_HZ / __os_tick_get_step();
+}
+#endif
+
+#if CONFIG_OS_USE_TICK_COUNTER == true
+/*! \brief Get the number of ticks since the start of the application
+ * \ingroup group_os_public_api
+ * \return The current value of the tick counter
+ * \pre \ref CONFIG_OS_USE_TICK_COUNTER needs to be set first.
+ */
+static inline os_tick_t os_get_tick_counter(void) {
+	extern volatile os_tick_t os_tick_counter;
+	return os_tick_counter;
+}
+#endif
+
 /*! \brief Start the task scheduling process
  * \ingroup group_os_public_api
  * \param ref_hz The frequency which runs the peripheral to generate
@@ -824,22 +1023,11 @@ static inline void os_start(uint32_t ref_hz) {
 #endif
 	/* Launch the scheduler */
 	os_yield();
-	/* Idle loop. This loop will control the application process but also
-	 * the event process.
-	 * They both run inside an infinite loop. They cannot run at the same
-	 * time.
+	/* Idle loop. The application process runs only when no other
+	 * processes are active or pending for events.
 	 */
 	while (true) {
-		/* If the event process is running, call the event scheduler */
-		if (__os_process_is_event(__os_process_get_current())) {
-			__os_event_scheduler();
-		}
-		/* Else it means the application process is running. In other
-		 * word, not other processes are actives or pending for events.
-		 */
-		else {
-			HOOK_OS_IDLE();
-		}
+		HOOK_OS_IDLE();
 	}
 }
 
@@ -858,7 +1046,13 @@ static inline char *os_get_version(void) {
 
 #include "os_interrupt.h"
 #include "os_semaphore.h"
+#include "os_event_group.h"
 #include "os_mutex.h"
+#include "os_cond.h"
+#include "os_rwlock.h"
+#include "os_barrier.h"
+#include "os_bus.h"
+#include "os_active.h"
 #include "os_statistics.h"
 
 #endif // __OS_CORE_H__
@@ -0,0 +1,206 @@
+/*! \file
+ * \brief eeOS Cyclic Executive
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+#if CONFIG_OS_USE_CYCLIC == true
+
+/*! \brief Compute the greatest common divisor of 2 numbers
+ */
+static os_tick_t __os_cyclic_gcd(os_tick_t a, os_tick_t b)
+{
+	os_tick_t r;
+	while (b) {
+		r = a % b;
+		a = b;
+		b = r;
+	}
+	return a;
+}
+
+/*! \brief Run the jobs of the pending frames back-to-back
+ * \param cyclic The cyclic executive
+ */
+static void __os_cyclic_dispatch(struct os_cyclic *cyclic)
+{
+	const struct os_cyclic_job *job;
+	os_tick_t time;
+	bool is_critical = os_is_critical();
+	int i;
+
+	while (cyclic->nb_pending) {
+		/* Fetch the oldest frame to be dispatched */
+		if (!is_critical) {
+			os_enter_critical();
+		}
+		time = cyclic->frame_time;
+		if (--cyclic->nb_pending) {
+			cyclic->frame_time += cyclic->frame;
+			if (cyclic->frame_time == cyclic->hyperperiod) {
+				cyclic->frame_time = 0;
+			}
+		}
+		cyclic->is_running = true;
+		if (!is_critical) {
+			os_leave_critical();
+		}
+		/* Run all the jobs released within this frame */
+		for (i = 0; i < cyclic->nb_jobs; i++) {
+			job = &cyclic->table[i];
+			if (time >= job->offset
+					&& ((time - job->offset) % job->period) == 0) {
+				job->job(job->args);
+			}
+		}
+		cyclic->is_running = false;
+	}
+}
+
+/*! \brief Advance the time of a cyclic executive by a tick
+ * \param cyclic The cyclic executive
+ * \param is_late Set if a frame released by a previous tick interrupt is
+ * still pending or running. It is cleared once the overrun is reported.
+ */
+static void __os_cyclic_tick(struct os_cyclic *cyclic, bool *is_late)
+{
+	struct os_process *proc;
+
+	/* Update the time within the hyperperiod */
+	if (++cyclic->time == cyclic->hyperperiod) {
+		cyclic->time = 0;
+	}
+	/* Release a frame only on frame boundaries */
+	if (cyclic->time % cyclic->frame) {
+		return;
+	}
+	/* The previous frame did not complete on time. The late frames which
+	 * did not start yet are dropped.
+	 */
+	if (*is_late) {
+		cyclic->overrun_counter++;
+		HOOK_OS_CYCLIC_OVERRUN(cyclic);
+		cyclic->nb_pending = 0;
+		*is_late = false;
+	}
+	/* Release the new frame, after the ones released by this same tick
+	 * interrupt.
+	 */
+	if (!cyclic->nb_pending) {
+		cyclic->frame_time = cyclic->time;
+	}
+	cyclic->nb_pending++;
+
+	if (cyclic->use_task) {
+		/* Wake up the dispatcher task */
+		proc = __os_task_get_process(&cyclic->task);
+		if (!__os_process_is_enabled(proc)) {
+			__os_process_enable_naked(proc);
+		}
+	}
+	else {
+		/* Run the jobs directly from the tick handler */
+		__os_cyclic_dispatch(cyclic);
+	}
+}
+
+/*! \brief Dispatcher task of a cyclic executive
+ * \param args The cyclic executive
+ */
+static void __os_cyclic_task(os_ptr_t args)
+{
+	struct os_cyclic *cyclic = (struct os_cyclic *) args;
+
+	while (true) {
+		__os_cyclic_dispatch(cyclic);
+		/* Wait for the next frame. The task will be enabled again by
+		 * the tick.
+		 */
+		os_enter_critical();
+		if (!cyclic->nb_pending) {
+			__os_process_disable(__os_task_get_process(&cyclic->task));
+		}
+		os_leave_critical();
+	}
+}
+
+bool os_cyclic_create(struct os_cyclic *cyclic,
+		const struct os_cyclic_job *table, int nb_jobs, os_tick_t frame)
+{
+	os_tick_t hyperperiod = frame;
+	os_tick_t factor;
+	int i;
+
+	if (!frame) {
+		return false;
+	}
+	/* Validate the table and compute the hyperperiod */
+	for (i = 0; i < nb_jobs; i++) {
+		if (!table[i].period || table[i].period % frame
+				|| table[i].offset % frame
+				|| table[i].offset >= table[i].period) {
+			return false;
+		}
+		factor = table[i].period / __os_cyclic_gcd(hyperperiod,
+				table[i].period);
+		/* Make sure the hyperperiod does not overflow */
+		if (hyperperiod > ((os_tick_t) -1) / factor) {
+			return false;
+		}
+		hyperperiod *= factor;
+	}
+
+	cyclic->table = table;
+	cyclic->nb_jobs = nb_jobs;
+	cyclic->frame = frame;
+	cyclic->hyperperiod = hyperperiod;
+	/* The first frame is released by the next tick */
+	cyclic->time = hyperperiod - 1;
+	cyclic->frame_time = 0;
+	cyclic->nb_pending = 0;
+	cyclic->is_running = false;
+	cyclic->use_task = false;
+	cyclic->overrun_counter = 0;
+	cyclic->tick = os_get_tick_counter();
+
+	return true;
+}
+
+bool os_cyclic_start(struct os_cyclic *cyclic, int stack_size,
+		enum os_task_option options)
+{
+	/* The dispatcher task is enabled by the tick only */
+	if (!os_task_create(&cyclic->task, __os_cyclic_task, (os_ptr_t) cyclic,
+			stack_size, options | OS_TASK_DISABLE)) {
+		return false;
+	}
+	cyclic->use_task = true;
+	return true;
+}
+
+void os_cyclic_tick(struct os_cyclic *cyclic)
+{
+	extern volatile os_tick_t os_tick_counter;
+	/* Only the frames released by a previous tick interrupt can be late */
+	bool is_late = (cyclic->nb_pending || cyclic->is_running);
+
+	/* Catch up with the tick counter, a tick interrupt can cover several
+	 * ticks (see \ref os_set_tick_rate).
+	 */
+	while (cyclic->tick != os_tick_counter) {
+		cyclic->tick++;
+		__os_cyclic_tick(cyclic, &is_late);
+	}
+}
+
+#endif
@@ -0,0 +1,225 @@
+/*! \file
+ * \brief eeOS Cyclic Executive
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_CYCLIC_H__
+#define __OS_CYCLIC_H__
+
+/*! \addtogroup group_os
+ * \section section_os_cyclic Cyclic Executive
+ *
+ * A cyclic executive (\ref os_cyclic) dispatches short periodic jobs from a
+ * static schedule table. Each entry (\ref os_cyclic_job) defines the offset
+ * and the period in ticks of a job, and the function to call. The jobs do not
+ * have their own stack, they run back-to-back on a single stack and do not
+ * need any context switch.
+ * \code
+ * static void poll_sensor_a(os_ptr_t args);
+ * static void poll_sensor_b(os_ptr_t args);
+ * static const struct os_cyclic_job my_table[] = {
+ *	OS_CYCLIC_JOB(0, 10, poll_sensor_a, NULL),
+ *	OS_CYCLIC_JOB(5, 20, poll_sensor_b, NULL),
+ * };
+ * struct os_cyclic my_cyclic;
+ * os_cyclic_create(&my_cyclic, my_table, 2, 5);
+ * os_cyclic_start(&my_cyclic, 512, OS_TASK_DEFAULT);
+ * \endcode
+ * And in the configuration file:
+ * \code #define HOOK_OS_TICK() os_cyclic_tick(&my_cyclic) \endcode
+ *
+ * The time is divided into frames of a fixed number of ticks. The offset and
+ * the period of every job must be multiples of the frame length, so jobs are
+ * only released at frame boundaries. The table repeats itself every
+ * hyperperiod, the least common multiple of all the periods.
+ *
+ * There are 2 dispatching modes:
+ * - With a dispatcher task (\ref os_cyclic_start). The jobs run on the stack of
+ *   this single task, which is enabled by \ref os_cyclic_tick at each frame
+ *   boundary and disables itself once the frame is completed. If a frame is
+ *   still running or has not started when the next frame boundary is reached,
+ *   an overrun is reported (\ref HOOK_OS_CYCLIC_OVERRUN) and the late frame is
+ *   dropped, so the schedule stays aligned with the time. The frames released
+ *   by a single tick interrupt covering several frames (see
+ *   \ref os_set_tick_rate) are not overruns, they are run back-to-back.
+ * - From the tick handler, if no dispatcher task is started. The jobs then run
+ *   with the interrupts masked and must complete well within a tick. Since
+ *   the tick interrupt cannot be nested, overruns cannot be detected in this
+ *   mode.
+ */
+
+/* Configuration options ******************************************************/
+
+/*! \def CONFIG_OS_USE_CYCLIC
+ * \brief Use this option to enable the cyclic executive support.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_TICK_COUNTER needs to be set, the frames are
+ * released by the tick.
+ */
+#ifndef CONFIG_OS_USE_CYCLIC
+	#define CONFIG_OS_USE_CYCLIC false
+#endif
+#if CONFIG_OS_USE_CYCLIC == true && CONFIG_OS_USE_TICK_COUNTER == false
+	#error The cyclic executive needs the tick counter.\
+			CONFIG_OS_USE_TICK_COUNTER must be set.
+#endif
+
+/* Hooks **********************************************************************/
+
+/*! \def HOOK_OS_CYCLIC_OVERRUN
+ * \brief This hook is called when a frame of a cyclic executive overruns its
+ * frame boundary. It is called from the tick interrupt.
+ * \param cyclic The cyclic executive (\ref os_cyclic)
+ * \ingroup os_hook
+ * \pre \ref CONFIG_OS_USE_CYCLIC needs to be set
+ */
+#ifndef HOOK_OS_CYCLIC_OVERRUN
+	#define HOOK_OS_CYCLIC_OVERRUN(cyclic)
+#endif
+
+/* Macros *********************************************************************/
+
+/*! \brief Define an entry of a schedule table
+ * \ingroup group_os_public_api
+ * \param offset The release offset of the job in ticks
+ * \param period The period of the job in ticks
+ * \param job The function to call (\ref os_proc_ptr_t)
+ * \param args The arguments to pass to this function
+ */
+#define OS_CYCLIC_JOB(offset, period, job, args) \
+		{(offset), (period), (job), (args)}
+
+/* Types **********************************************************************/
+
+#if CONFIG_OS_USE_CYCLIC == true
+/*! \brief Entry of a schedule table
+ */
+struct os_cyclic_job {
+	/*! \brief Release offset of the job in ticks
+	 */
+	os_tick_t offset;
+	/*! \brief Period of the job in ticks
+	 */
+	os_tick_t period;
+	/*! \brief Function to be called
+	 */
+	os_proc_ptr_t job;
+	/*! \brief Arguments to pass to the function
+	 */
+	os_ptr_t args;
+};
+
+/*! \brief Cyclic executive
+ */
+struct os_cyclic {
+	/*! \brief The schedule table
+	 */
+	const struct os_cyclic_job *table;
+	/*! \brief Number of entries in the schedule table
+	 */
+	int nb_jobs;
+	/*! \brief Length of a frame in ticks
+	 */
+	os_tick_t frame;
+	/*! \brief Length of the schedule in ticks
+	 */
+	os_tick_t hyperperiod;
+	/*! \brief Last tick processed
+	 */
+	os_tick_t tick;
+	/*! \brief Current time within the hyperperiod
+	 */
+	os_tick_t time;
+	/*! \brief Time of the frame to be dispatched
+	 */
+	os_tick_t frame_time;
+	/*! \brief Number of frames released and not yet dispatched. Several
+	 * frames can be released by a single tick interrupt.
+	 */
+	volatile os_tick_t nb_pending;
+	/*! \brief Set while the jobs of a frame are running
+	 */
+	volatile bool is_running;
+	/*! \brief true if the frames are dispatched by the dispatcher task
+	 */
+	bool use_task;
+	/*! \brief Number of frame overruns
+	 */
+	uint32_t overrun_counter;
+	/*! \brief The dispatcher task
+	 */
+	struct os_task task;
+};
+#endif
+
+/* Public API *****************************************************************/
+
+#if CONFIG_OS_USE_CYCLIC == true
+/*! \name Cyclic Executive
+ *
+ * Set of functions to manage a cyclic executive
+ *
+ * \{
+ */
+
+/*! \brief Create a cyclic executive
+ * \ingroup group_os_public_api
+ * \param cyclic The cyclic executive to be initialized
+ * \param table The schedule table. It is not copied, so it must stay valid.
+ * \param nb_jobs The number of entries in the schedule table
+ * \param frame The length of a frame in ticks
+ * \return true if the table is valid, false otherwise (an offset or a period
+ * is not a multiple of the frame, an offset is larger than its period or the
+ * hyperperiod does not fit into \ref os_tick_t).
+ * \pre \ref CONFIG_OS_USE_CYCLIC needs to be set
+ */
+bool os_cyclic_create(struct os_cyclic *cyclic,
+		const struct os_cyclic_job *table, int nb_jobs, os_tick_t frame);
+
+/*! \brief Create the dispatcher task of a cyclic executive. All the jobs will
+ * run on the stack of this task.
+ * \ingroup group_os_public_api
+ * \param cyclic The cyclic executive
+ * \param stack_size The size of the stack in byte
+ * \param options Options for the dispatcher task (see \ref os_task_option).
+ * With \ref OS_TASK_USE_CUSTOM_STACK, the stack must be set in
+ * \ref os_cyclic::task first.
+ * \return true if the task has been correctly created, false otherwise.
+ * \pre \ref CONFIG_OS_USE_CYCLIC needs to be set
+ */
+bool os_cyclic_start(struct os_cyclic *cyclic, int stack_size,
+		enum os_task_option options);
+
+/*! \brief Advance the time of a cyclic executive by a tick and release a frame
+ * on a frame boundary. This function must be called from \ref HOOK_OS_TICK.
+ * \ingroup group_os_public_api
+ * \param cyclic The cyclic executive
+ * \pre \ref CONFIG_OS_USE_CYCLIC needs to be set
+ */
+void os_cyclic_tick(struct os_cyclic *cyclic);
+
+/*! \brief Get the number of frame overruns of a cyclic executive
+ * \ingroup group_os_public_api
+ * \param cyclic The cyclic executive
+ * \return The number of overruns since its creation
+ * \pre \ref CONFIG_OS_USE_CYCLIC needs to be set
+ */
+static inline uint32_t os_cyclic_get_overrun(struct os_cyclic *cyclic) {
+	return cyclic->overrun_counter;
+}
+
+/*!
+ * \}
+ */
+#endif
+
+#endif // __OS_CYCLIC_H__
@@ -146,6 +146,10 @@ enum os_debug_trace_event {
 	OS_DEBUG_TRACE_TASK_DELAY_START = 0x16,
 	/*! \brief When \ref os_task_delay is done */
 	OS_DEBUG_TRACE_TASK_DELAY_STOP = 0x17,
+	/*! \brief When \ref os_task_delay_until is called */
+	OS_DEBUG_TRACE_TASK_DELAY_UNTIL_START = 0x18,
+	/*! \brief When \ref os_task_delay_until is done */
+	OS_DEBUG_TRACE_TASK_DELAY_UNTIL_STOP = 0x19,
 
 	/* Software interrupt related */
 	/*! \brief When \ref os_interrupt_create is called */
@@ -156,6 +160,10 @@ enum os_debug_trace_event {
 	OS_DEBUG_TRACE_INTERRUPT_SET_PRIORITY = 0x22,
 	/*! \brief When \ref os_interrupt_get_priority is called */
 	OS_DEBUG_TRACE_INTERRUPT_GET_PRIORITY = 0x23,
+	/*! \brief When \ref os_interrupt_trigger_on_event is called */
+	OS_DEBUG_TRACE_INTERRUPT_TRIGGER_ON_EVENT = 0x24,
+	/*! \brief When \ref os_interrupt_detach_event is called */
+	OS_DEBUG_TRACE_INTERRUPT_DETACH_EVENT = 0x25,
 };
 
 /*! \brief Trace structure. This structure contains the format of a trace entry.
@@ -17,10 +17,66 @@
 
 #if CONFIG_OS_USE_EVENTS == true
 
-/*! \brief Active event list. This pointer points on the 1rst active event
- * registered in the evetn chain list.
+/*! \brief Active event lists, one per priority level. Within a level, the
+ * events are evaluated in the order they have been enabled.
  */
-static struct os_event *__os_current_event = NULL;
+static struct {
+	/*! \brief First event of the list */
+	struct os_event *first;
+	/*! \brief Last event of the list */
+	struct os_event *last;
+} __os_event_active[CONFIG_OS_EVENT_NB_PRIORITIES];
+
+/*! \brief Bitmap of the priority levels which have active events. Bit n is set
+ * if the level n is not empty.
+ */
+static uint32_t __os_event_active_mask = 0;
+
+/*! \brief Stack of the event process.
+ */
+static OS_MALLOC_STACK(__os_event_stack, CONFIG_OS_EVENT_STACK_SIZE);
+
+/*! \brief Context of the event process. Its stack pointer is set only when the
+ * process is created, the first time it gets enabled.
+ */
+static struct os_process __os_event_process = {
+	.sp = NULL,
+	.status = OS_PROCESS_IDLE,
+	.type = OS_PROCESS_TYPE_EVENT,
+};
+
+/*! \brief Entry point of the event process. It runs the event scheduler
+ * forever, the process disables itself when no more events are active.
+ * \param args Not used
+ */
+static void __os_event_process_handler(os_ptr_t args)
+{
+	while (true) {
+		__os_event_scheduler();
+	}
+}
+
+void __os_process_event_enable(void)
+{
+	/* Create the event process if not done already */
+	if (!__os_event_process.sp) {
+		__os_process_create(&__os_event_process,
+				&__os_event_stack[CONFIG_OS_EVENT_STACK_SIZE],
+				OS_PROCESS_TYPE_EVENT);
+#if CONFIG_OS_USE_PRIORITY == true
+		__os_process_set_priority(&__os_event_process,
+				CONFIG_OS_EVENT_PRIORITY);
+#endif
+		os_process_context_load(&__os_event_process,
+				__os_event_process_handler, NULL);
+	}
+	__os_process_enable(&__os_event_process);
+}
+
+void __os_process_event_disable(void)
+{
+	__os_process_disable(&__os_event_process);
+}
 
 void __os_event_create(struct os_event *event,
 		const struct os_event_descriptor *descriptor, os_ptr_t args)
@@ -31,49 +87,75 @@ void __os_event_create(struct os_event *event,
 	event->desc.is_triggered = descriptor->is_triggered;
 	/* Associate arguments to the event */
 	event->args = args;
+	/* Lowest priority by default */
+	event->priority = CONFIG_OS_EVENT_NB_PRIORITIES - 1;
+	event->is_active = false;
 	/* Mark this event as disabled */
 	event->queue.next = NULL;
-	event->queue.prev = NULL;
+	event->queue.prev = &event->queue;
+}
+
+/*! \brief Remove a process entry from the list of its event. The last entry
+ * pointer of the event is updated if needed.
+ * \param queue_elt The entry to be removed
+ */
+static inline void __os_event_unregister(struct os_queue_event *queue_elt) {
+	/* If this is the last entry, the previous one becomes the last */
+	if (!queue_elt->next) {
+		queue_elt->event->queue.prev =
+				os_queue_event_get_queue_doubly(queue_elt->prev);
+	}
+	os_queue_event_remove(queue_elt);
 }
 
 /*! \brief Remove an event from the active event list.
+ * \param level The priority level of the event
+ * \param prev_event The event preceding it in the list, NULL if it is the
+ * first one
  * \param event The event to be removed from the list
  * \warning The event must be in the event list
  */
-static inline void __os_event_pop(struct os_event *event) {
-	struct os_event *prev_event = __os_current_event;
+static inline void __os_event_pop(int level, struct os_event *prev_event,
+		struct os_event *event) {
 	/* If the event is the 1rst one */
-	if (event == __os_current_event) {
-		/* Modify the active event pointer to point on the next element
-		 */
-		__os_current_event = event->next;
+	if (!prev_event) {
+		__os_event_active[level].first = event->next;
 	}
 	/* The event is not the 1rst one */
 	else {
-		/* Look for the event in the list */
-		while (prev_event->next != event) {
-			prev_event = prev_event->next;
-		}
-		/* Remove the event from the list */
 		prev_event->next = event->next;
 	}
+	/* Update the last event of the list */
+	if (__os_event_active[level].last == event) {
+		__os_event_active[level].last = prev_event;
+	}
+	event->is_active = false;
+	/* Mark the level as empty */
+	if (!__os_event_active[level].first) {
+		__os_event_active_mask &= ~(1UL << level);
+	}
 }
 
-/*! \brief Add a new event to the active event list
+/*! \brief Add a new event at the end of the active event list of its priority
+ * level
  * \param event The event to be added
  * \warning The event must not be active
  */
 static inline void __os_event_enable(struct os_event *event) {
+	int level = event->priority;
+
+	event->next = NULL;
 	/* If the active event list is not empty */
-	if (__os_current_event) {
-		event->next = __os_current_event;
+	if (__os_event_active[level].first) {
+		__os_event_active[level].last->next = event;
 	}
 	/* The active event list is empty */
 	else {
-		event->next = NULL;
+		__os_event_active[level].first = event;
+		__os_event_active_mask |= (1UL << level);
 	}
-	/* The new event will be the 1rst one in the list */
-	__os_current_event = event;
+	__os_event_active[level].last = event;
+	event->is_active = true;
 }
 
 /*! \brief Initialize the event by calling its setup function
@@ -89,30 +171,11 @@ static inline void __os_event_start(struct os_event *event,
 	}
 }
 
-/*! \brief Register an event into the active event list
- * \param event The event to register
- * \param queue_elt The queue element structure to add to the list
- * \param proc The process associated with this queue element
- * \param event_triggered The pointer on the variable to update to notify which
- * event has triggered
- * \warning This function must be called inside a critical section
- */
-static void __os_event_register(struct os_event *event,
+void __os_event_register(struct os_event *event,
 		struct os_queue_event *queue_elt, struct os_process *proc,
 		struct os_event **event_triggered)
 {
-	os_queue_doubly_sort_t sort_fct;
-
-	/* Get the appropriate sorting function */
-#if CONFIG_OS_USE_PRIORITY == true
-	sort_fct = os_queue_doubly_process_sort_priority;
-#else
-	sort_fct = (os_queue_doubly_sort_t) os_queue_sort_fifo;
-#endif
-	/* If a custom sorting function is defined for this event, use it */
-	if (event->desc.sort) {
-		sort_fct = event->desc.sort;
-	}
+	struct os_queue_event *prev_elt;
 
 	/* Enable the event process if not done already, before messing up
 	 * with the process context
@@ -128,45 +191,122 @@ static void __os_event_register(struct os_event *event,
 	queue_elt->proc = proc;
 	/* Assign the variable to update when the event has been triggered */
 	queue_elt->event_triggered = event_triggered;
+	queue_elt->event = event;
+
+	/* If a custom sorting function is defined for this event, use it */
+	if (event->desc.sort) {
+		os_queue_event_add_sort(__os_event_get_queue_ptr(event),
+				queue_elt, event->desc.sort);
+		if (!queue_elt->next) {
+			event->queue.prev = os_queue_event_get_queue_doubly(queue_elt);
+		}
+		return;
+	}
 
-	/* Add the process to the event sorted process list */
-	os_queue_event_add_sort(__os_event_get_queue_ptr(event),
-			queue_elt, sort_fct);
+	/* Else the processes are sorted in FIFO order (within each priority
+	 * level if priorities are enabled). Start from the last entry, so that
+	 * appending a process takes a constant time.
+	 */
+	prev_elt = os_queue_event_from_queue_doubly(event->queue.prev);
+#if CONFIG_OS_USE_PRIORITY == true
+	while (prev_elt != os_queue_event_from_queue_doubly(&event->queue)
+			&& prev_elt->proc->priority > proc->priority) {
+		prev_elt = prev_elt->prev;
+	}
+#endif
+	os_queue_event_insert_after(prev_elt, queue_elt);
+	/* Update the last entry pointer */
+	if (!queue_elt->next) {
+		event->queue.prev = os_queue_event_get_queue_doubly(queue_elt);
+	}
 }
 
-/*! \brief Event scheduler. This function will check the evnet status and wake
- * up the associated processes accordingly. It will then make sure the active
- * event list is clean.
+#if CONFIG_OS_EVENT_MAX_EVALUATIONS > 0
+/*! \brief Rotate the active event list of a priority level so that an event
+ * becomes the first one. The events before it are moved at the end of the
+ * list, so that all the events of the level are evaluated in turn.
+ * \param level The priority level of the event
+ * \param prev_event The event preceding it in the list, NULL if it is the
+ * first one
+ * \param event The event which becomes the first one
+ */
+static inline void __os_event_rotate(int level, struct os_event *prev_event,
+		struct os_event *event) {
+	if (prev_event) {
+		__os_event_active[level].last->next =
+				__os_event_active[level].first;
+		__os_event_active[level].first = event;
+		__os_event_active[level].last = prev_event;
+		prev_event->next = NULL;
+	}
+}
+#endif
+
+#if CONFIG_OS_EVENT_CRITICAL_CHUNK > 0
+/*! \brief Leave the critical region for a moment to let the pending interrupts
+ * run, and possibly the other processes.
+ *
+ * The position of the event scheduler in the active event lists stays valid
+ * across this window: only the event process removes events from these lists
+ * or reorders them. The other processes and the interrupts only append events
+ * at the end of a list, and append or unlink the waiters of an event.
+ */
+static inline void __os_event_preempt(void) {
+	os_leave_critical();
+	os_enter_critical();
+}
+#endif
+
+/*! \brief Event scheduler. This function will check the event status and wake
+ * up the associated processes accordingly, starting with the events of the
+ * highest priority. It will then make sure the active event list is clean.
  */
 void __os_event_scheduler(void)
 {
 	/* To hold the current event to process */
 	struct os_event *event;
+	/* Previous event in the list of the current priority level */
+	struct os_event *prev_event;
 	/* Status of the current event */
-	enum os_event_status status = OS_EVENT_NONE;
+	enum os_event_status status;
+	/* Priority levels left to process */
+	uint32_t mask;
+	int level;
+#if CONFIG_OS_EVENT_MAX_EVALUATIONS > 0
+	/* Number of evaluations left within this pass */
+	int budget = CONFIG_OS_EVENT_MAX_EVALUATIONS;
+#endif
+#if CONFIG_OS_EVENT_CRITICAL_CHUNK > 0
+	/* Number of steps left before the interrupts are enabled again */
+	int chunk = CONFIG_OS_EVENT_CRITICAL_CHUNK;
+#endif
 
-	/* All the following cannot be interrupted since manupulating the
-	 * active event list is critical.
+	/* Manipulating the active event list is critical. The critical
+	 * region is left regularly though, every
+	 * CONFIG_OS_EVENT_CRITICAL_CHUNK steps, to bound the interrupt
+	 * latency whatever the number of events.
 	 */
 	os_enter_critical();
 
-	/* Start with the first event to process */
-	event = __os_current_event;
-
 	/* If no events, disable the event process */
-	if (!event) {
+	if (!__os_event_active_mask) {
 		/* Disable the event process */
 		__os_process_event_disable();
 	}
 
-	/* Loop inside the active event list */
-	while (event) {
-		/* Loop until the status of the current event is "stop" */
-		do {
-			/* If the process queue of the current event is not
-			 * empty
+	/* Loop through the priority levels, the highest first */
+	mask = __os_event_active_mask;
+	while (mask) {
+		level = ctz(mask);
+		mask &= ~(1UL << level);
+		prev_event = NULL;
+		event = __os_event_active[level].first;
+		/* Loop inside the active event list of this level */
+		while (event) {
+			/* Loop while the status of the current event is
+			 * "continue" and processes are associated with it.
 			 */
-			if (!__os_event_is_empty(event)) {
+			while (!__os_event_is_empty(event)) {
 				struct os_queue_event *queue_elt;
 				/* Get the first process associated with the
 				 * current event
@@ -175,6 +315,19 @@ void __os_event_scheduler(void)
 						__os_event_get_queue(event));
 				/* Make sure the process is in pending state */
 				if (__os_process_is_pending(queue_elt->proc)) {
+#if CONFIG_OS_EVENT_MAX_EVALUATIONS > 0
+					/* If the budget is exhausted, stop
+					 * here. The next pass resumes from this
+					 * event, with its remaining waiters.
+					 */
+					if (budget <= 0) {
+						__os_event_rotate(level,
+								prev_event,
+								event);
+						goto end_of_pass;
+					}
+					budget--;
+#endif
 					/* Check if the event has been triggered
 					 */
 					status = event->desc.is_triggered(
@@ -191,8 +344,7 @@ void __os_event_scheduler(void)
 						/* Remove the process from the
 						 * event list
 						 */
-						os_queue_event_pop(
-								__os_event_get_queue_ptr(event));
+						__os_event_unregister(queue_elt);
 						/* Activate the process */
 						__os_process_enable_naked(queue_elt->proc);
 						/* Garbage collect, remove the other
@@ -204,7 +356,7 @@ void __os_event_scheduler(void)
 						 * them
 						 */
 						while (current_elt != queue_elt) {
-							os_queue_event_remove(current_elt);
+							__os_event_unregister(current_elt);
 							current_elt = current_elt->relation;
 						}
 					}
@@ -213,42 +365,57 @@ void __os_event_scheduler(void)
 				 * of the event list. This should never happen.
 				 */
 				else {
-					// while (true);
 					/* Remove the not pending process from
 					 * the list.
 					 */
-					os_queue_event_pop(__os_event_get_queue_ptr(event));
+					__os_event_unregister(queue_elt);
 					/* Continue processing the next process
 					 * in the list.
 					 */
 					status = OS_EVENT_OK_CONTINUE;
 				}
+				/* Stop unless the status is set to "continue" */
+				if (status != OS_EVENT_OK_CONTINUE) {
+					break;
+				}
+#if CONFIG_OS_EVENT_CRITICAL_CHUNK > 0
+				/* Let the interrupts in between 2 waiters.
+				 * The event itself can only be removed from
+				 * its list by this process, so its queue is
+				 * simply read again.
+				 */
+				if (!--chunk) {
+					chunk = CONFIG_OS_EVENT_CRITICAL_CHUNK;
+					__os_event_preempt();
+				}
+#endif
 			}
-
-		/* Loop until the status is set to "continue" */
-		} while (status == OS_EVENT_OK_CONTINUE);
-		/* Get the next active event */
-		event = event->next;
-	}
-
-	/* Start with the first event to process */
-	event = __os_current_event;
-	/* Garbage collector, test if there are empty events, if so remove them
-	 */
-	while (event) {
-		/* If the process queue of the current event is empty,
-		 * remove this event from the active event list.
-		 */
-		if (__os_event_is_empty(event)) {
-			/* Change the status to exit the main loop */
-			status = OS_EVENT_NONE;
-			/* Remove this event from the active event list
+			/* Garbage collector, if the process queue of the
+			 * current event is empty, remove this event from the
+			 * active event list.
 			 */
-			__os_event_pop(event);
+			if (__os_event_is_empty(event)) {
+				__os_event_pop(level, prev_event, event);
+			}
+			else {
+				prev_event = event;
+			}
+#if CONFIG_OS_EVENT_CRITICAL_CHUNK > 0
+			/* Let the interrupts in between 2 events */
+			if (!--chunk) {
+				chunk = CONFIG_OS_EVENT_CRITICAL_CHUNK;
+				__os_event_preempt();
+			}
+#endif
+			/* Get the next active event */
+			event = (prev_event) ? prev_event->next
+					: __os_event_active[level].first;
 		}
-		event = event->next;
 	}
 
+#if CONFIG_OS_EVENT_MAX_EVALUATIONS > 0
+end_of_pass:
+#endif
 	/* Manually call the scheduler to schedule the next process */
 	os_switch_context(false);
 
@@ -273,12 +440,19 @@ enum os_event_status __os_event_custom_function_handler(struct os_process *proc,
 	return OS_EVENT_NONE;
 }
 
-struct os_event *__os_process_sleep(struct os_process *proc,
-		struct os_queue_event *queue_elt, int nb_events, ...)
+/*! \brief Send a process to sleep on the events already assigned to the queue
+ * elements.
+ * \param proc The processus to send to sleep
+ * \param queue_elt The array of queue elements, the \b event field of each
+ * element must be set.
+ * \param nb_events The number of elements
+ * \return A pointer on the event which woke up the process
+ */
+static struct os_event *__os_process_sleep_on(struct os_process *proc,
+		struct os_queue_event *queue_elt, int nb_events)
 {
 	int i;
-	va_list ap;
-	struct os_event *event, *event_triggered = NULL;
+	struct os_event *event_triggered = NULL;
 	/* Save the critical region status */
 	bool is_critical = os_is_critical();
 
@@ -303,22 +477,18 @@ struct os_event *__os_process_sleep(struct os_process *proc,
 	/* Initialize relation pointer between the queue elements */
 	queue_elt[0].relation = &queue_elt[0];
 
-	va_start(ap, nb_events);
-	i = nb_events;
-	while (i--) {
-		/* Get the next event from the list */
-		event = va_arg(ap, struct os_event *);
+	for (i = 0; i < nb_events; i++) {
 		/* Start the event */
-		__os_event_start(event, proc);
+		__os_event_start(queue_elt[i].event, proc);
 		/* Register the process in the active event list */
-		__os_event_register(event, &queue_elt[i], proc, &event_triggered);
+		__os_event_register(queue_elt[i].event, &queue_elt[i], proc,
+				&event_triggered);
 		/* Build a relation between the processes registered */
 		if (i) {
 			queue_elt[i].relation = queue_elt[0].relation;
 			queue_elt[0].relation = &queue_elt[i];
 		}
 	}
-	va_end(ap);
 
 	/* If the process to be send to sleep is thye current process, stop it
 	 * and use a garbage collector wipe out the extra events registered.
@@ -337,20 +507,149 @@ struct os_event *__os_process_sleep(struct os_process *proc,
 	return event_triggered;
 }
 
+struct os_event *__os_process_sleep(struct os_process *proc,
+		struct os_queue_event *queue_elt, int nb_events, ...)
+{
+	int i;
+	va_list ap;
+
+	/* Assign the events to the queue elements */
+	va_start(ap, nb_events);
+	for (i = 0; i < nb_events; i++) {
+		queue_elt[i].event = va_arg(ap, struct os_event *);
+	}
+	va_end(ap);
+
+	return __os_process_sleep_on(proc, queue_elt, nb_events);
+}
+
+struct os_event *__os_process_sleep_array(struct os_process *proc,
+		struct os_queue_event *queue_elt, struct os_event * const *events,
+		int nb_events)
+{
+	int i;
+
+	/* Assign the events to the queue elements */
+	for (i = 0; i < nb_events; i++) {
+		queue_elt[i].event = events[i];
+	}
+
+	return __os_process_sleep_on(proc, queue_elt, nb_events);
+}
+
 
 #if CONFIG_OS_USE_SW_INTERRUPTS == true
-	#warning TODO the interrupt trigger_on_event function
+void __os_interrupt_event_register(struct os_interrupt *interrupt)
+{
+	struct os_process *proc = __os_interrupt_get_process(interrupt);
+
+	/* The interrupt waits for its event, like a sleeping process */
+	proc->status = OS_PROCESS_PENDING;
+	/* Its entry is not related to any other event */
+	interrupt->queue_elt.relation = &interrupt->queue_elt;
+	interrupt->event_triggered = NULL;
+	/* Start the event */
+	__os_event_start(interrupt->event, proc);
+	/* Register the interrupt in the active event list */
+	__os_event_register(interrupt->event, &interrupt->queue_elt, proc,
+			&interrupt->event_triggered);
+}
+
+/*! \brief Cancel the entry of an interrupt in the active event list if it is
+ * waiting for its event, without entering the critical region.
+ * \param interrupt The interrupt
+ */
+static void __os_interrupt_event_cancel(struct os_interrupt *interrupt)
+{
+	struct os_process *proc = __os_interrupt_get_process(interrupt);
+
+	/* The event itself will be garbage collected by the event scheduler */
+	if (__os_process_is_pending(proc)) {
+		__os_event_unregister(&interrupt->queue_elt);
+		proc->status = OS_PROCESS_IDLE;
+	}
+}
+
+/*! \brief Detach an interrupt from its event, without entering the critical
+ * region.
+ * \param interrupt The interrupt
+ */
+static void __os_interrupt_detach_event(struct os_interrupt *interrupt)
+{
+	__os_interrupt_event_cancel(interrupt);
+	interrupt->event = NULL;
+}
+
+void __os_interrupt_trigger(struct os_interrupt *interrupt)
+{
+	struct os_process *proc = __os_interrupt_get_process(interrupt);
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* An interrupt waiting for its event must leave the active event list
+	 * before running, it is registered again once its handler has been
+	 * executed.
+	 */
+	__os_interrupt_event_cancel(interrupt);
+	if (!__os_process_is_enabled(proc)) {
+		__os_process_enable_naked(proc);
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
 void os_interrupt_trigger_on_event(struct os_interrupt *interrupt,
 		struct os_event *event)
 {
 	/* Save the critical region status */
 	bool is_critical = os_is_critical();
+
+	__HOOK_OS_DEBUG_TRACE_LOG(OS_DEBUG_TRACE_INTERRUPT_TRIGGER_ON_EVENT,
+			interrupt);
+
 	/* Enter in a critical region if not already in */
 	if (!is_critical) {
 		os_enter_critical();
 	}
-	//__os_event_start(event);
-	//__os_event_register(event, __os_interrupt_get_process(interrupt));
+	/* Detach it from its previous event if any */
+	if (interrupt->event) {
+		__os_interrupt_detach_event(interrupt);
+	}
+	interrupt->event = event;
+	/* If the interrupt is currently enabled, it will be registered once its
+	 * handler has been executed.
+	 */
+	if (!__os_process_is_enabled(__os_interrupt_get_process(interrupt))) {
+		__os_interrupt_event_register(interrupt);
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+void os_interrupt_detach_event(struct os_interrupt *interrupt)
+{
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	__HOOK_OS_DEBUG_TRACE_LOG(OS_DEBUG_TRACE_INTERRUPT_DETACH_EVENT,
+			interrupt);
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	if (interrupt->event) {
+		__os_interrupt_detach_event(interrupt);
+	}
+	/* Leave the critical region unless the CPU was previously in */
 	if (!is_critical) {
 		os_leave_critical();
 	}
@@ -33,11 +33,25 @@
  * When an event has no associated process, it is considered as inactive and is
  * removed from the active event list.
  *
- * The event scheduler runs with the application process. They share the same
- * context and therefore the same stack. You can change the priority of the
- * event process (in other word, you can change the priority of the event
- * scheduler). This will not affect the priority of the application process
- * since this process is active only when no other processes are actives.
+ * Each event has a priority (\ref os_event_set_priority). The active events
+ * are kept in one list per priority level, and the event scheduler evaluates
+ * the levels from the highest priority to the lowest. To bound the time before
+ * a high priority event is evaluated, the number of evaluations per pass of
+ * the event scheduler can be limited (\ref CONFIG_OS_EVENT_MAX_EVALUATIONS).
+ *
+ * A process waiting on several events gets one record (\ref os_queue_event)
+ * per event, all allocated in a single block on its stack. Each record is
+ * appended to the process list of its event in constant time, and as soon as
+ * one event wakes up the process, the other records are unlinked in constant
+ * time each. Waiting on many events therefore costs about the same per event
+ * as waiting on a single one.
+ *
+ * The event scheduler runs within a dedicated process (the event process), with
+ * its own stack (\ref CONFIG_OS_EVENT_STACK_SIZE) and its own priority
+ * (\ref CONFIG_OS_EVENT_PRIORITY). It is part of the active process list only
+ * while at least one event is active, so the application process stays idle
+ * otherwise. Giving the event process a higher priority than the background
+ * tasks makes the event wake ups more reactive.
  */
 
 /* Configuration options ******************************************************/
@@ -50,6 +64,63 @@
 	#define CONFIG_OS_USE_EVENTS false
 #endif
 
+/*! \def CONFIG_OS_EVENT_STACK_SIZE
+ * \brief Size in bytes of the stack used by the event process.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_EVENTS needs to be set
+ */
+#ifndef CONFIG_OS_EVENT_STACK_SIZE
+	#define CONFIG_OS_EVENT_STACK_SIZE 512
+#endif
+
+/*! \def CONFIG_OS_EVENT_PRIORITY
+ * \brief Priority assigned to the event process.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_EVENTS and \ref CONFIG_OS_USE_PRIORITY need to be
+ * set
+ */
+#ifndef CONFIG_OS_EVENT_PRIORITY
+	#define CONFIG_OS_EVENT_PRIORITY OS_PRIORITY_1
+#endif
+
+/*! \def CONFIG_OS_EVENT_NB_PRIORITIES
+ * \brief Number of event priority levels, up to 32. The level 0 is the highest
+ * priority.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_EVENTS needs to be set
+ */
+#ifndef CONFIG_OS_EVENT_NB_PRIORITIES
+	#define CONFIG_OS_EVENT_NB_PRIORITIES 4
+#endif
+#if CONFIG_OS_EVENT_NB_PRIORITIES < 1 || CONFIG_OS_EVENT_NB_PRIORITIES > 32
+	#error CONFIG_OS_EVENT_NB_PRIORITIES must be between 1 and 32.
+#endif
+
+/*! \def CONFIG_OS_EVENT_MAX_EVALUATIONS
+ * \brief Maximum number of event evaluations per pass of the event scheduler.
+ * Once reached, the event process yields the CPU, and the next pass starts
+ * again from the highest priority events. A level resumes from the event it
+ * stopped on, so that all its events and their waiters are evaluated in turn.
+ * Set to 0 for no limit.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_EVENTS needs to be set
+ */
+#ifndef CONFIG_OS_EVENT_MAX_EVALUATIONS
+	#define CONFIG_OS_EVENT_MAX_EVALUATIONS 0
+#endif
+
+/*! \def CONFIG_OS_EVENT_CRITICAL_CHUNK
+ * \brief Number of steps (waiter evaluations or events visited) the event
+ * scheduler performs with the interrupts disabled. The interrupts are then
+ * enabled for a moment before the next chunk. Set to 0 to run a whole pass
+ * with the interrupts disabled.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_EVENTS needs to be set
+ */
+#ifndef CONFIG_OS_EVENT_CRITICAL_CHUNK
+	#define CONFIG_OS_EVENT_CRITICAL_CHUNK 4
+#endif
+
 /* Types **********************************************************************/
 
 /*! \brief Status returned by an event
@@ -116,6 +187,8 @@ OS_QUEUE_DOUBLY_DEFINE(event,
 	 * with other processes
 	 */
 	struct os_queue_event *relation;
+	/*! The event this entry is registered to */
+	struct os_event *event;
 );
 
 /*! \brief Event structure
@@ -126,7 +199,10 @@ struct os_event {
 	 */
 	struct os_event_descriptor desc;
 	/*! \brief This is the starting point of the process chain list associated
-	 * with this event. The last process is followed by a NULL pointer.
+	 * with this event. The last process is followed by a NULL pointer. The
+	 * \b prev field points on the last process of the list (or on this
+	 * structure if the list is empty), to append new processes in constant
+	 * time.
 	 */
 	struct os_queue_doubly queue;
 	/*! \brief Next event in the chain list. Last event is followed by a
@@ -136,6 +212,12 @@ struct os_event {
 	/*! \brief Extra arguments used to define this event.
 	 */
 	os_ptr_t args;
+	/*! \brief Priority level of the event, 0 is the highest.
+	 */
+	uint8_t priority;
+	/*! \brief Set while the event is in the active event list.
+	 */
+	bool is_active;
 };
 
 /*! \brief Internal structure to fit a boolean function in a event
@@ -175,6 +257,17 @@ enum os_event_status __os_event_custom_function_handler(struct os_process *proc,
  */
 void __os_event_scheduler(void);
 
+/*! \brief Enable the event process. The event process is created the first
+ * time this function is called.
+ * \ingroup group_os_internal_api
+ */
+void __os_process_event_enable(void);
+
+/*! \brief Disable the event process
+ * \ingroup group_os_internal_api
+ */
+void __os_process_event_disable(void);
+
 /*! \brief This function test a event structure and notifies if it has any
  * remaining process in its queue.
  * \ingroup group_os_internal_api
@@ -192,7 +285,7 @@ static inline bool __os_event_is_empty(struct os_event *event) {
  * \return true if the event is enabled, false otherwise.
  */
 static inline bool __os_event_is_enabled(struct os_event *event) {
-	return (bool) (event->queue.next);
+	return event->is_active;
 }
 
 /*! \brief Generic function to send a processus to sleep. The process can be
@@ -208,6 +301,20 @@ static inline bool __os_event_is_enabled(struct os_event *event) {
 struct os_event *__os_process_sleep(struct os_process *proc,
 		struct os_queue_event *queue_elt, int nb_events, ...);
 
+/*! \brief Same as \ref __os_process_sleep, but the events are passed as an
+ * array.
+ * \ingroup group_os_internal_api
+ * \param proc The processus to send to sleep
+ * \param queue_elt An array of \b nb_events empty \ref os_queue_event
+ * structures to hold each process instance in the events.
+ * \param events The array of \ref os_event which can wake up this process
+ * \param nb_events The number of events in the array
+ * \return A pointer on the event which woke up the process
+ */
+struct os_event *__os_process_sleep_array(struct os_process *proc,
+		struct os_queue_event *queue_elt, struct os_event * const *events,
+		int nb_events);
+
 /*! \brief Associate a process with an event and enable the event
  * \ingroup group_os_internal_api
  * \param event The event to receive the process
@@ -216,6 +323,7 @@ struct os_event *__os_process_sleep(struct os_process *proc,
  * \param proc The process to add
  * \param event_triggered A pointer to update which will reflect the event that
  * has been triggered
+ * \warning This function must be called inside a critical section
  */
 void __os_event_register(struct os_event *event, struct os_queue_event *queue_elt,
 		struct os_process *proc, struct os_event **event_triggered);
@@ -272,6 +380,20 @@ static inline void os_event_create_from_function(struct os_event *event,
 	__os_event_create(event, &descriptor, (os_ptr_t) &custom_args);
 }
 
+/*! \brief Set the priority of an event. It must be called before the event is
+ * used, while no process waits on it.
+ * \ingroup group_os_public_api
+ * \param event The event
+ * \param priority The priority level, from 0 (the highest) to
+ * \ref CONFIG_OS_EVENT_NB_PRIORITIES - 1 (the default).
+ * \pre \ref CONFIG_OS_USE_EVENTS needs to be set
+ */
+static inline void os_event_set_priority(struct os_event *event,
+		uint8_t priority) {
+	event->priority = (priority < CONFIG_OS_EVENT_NB_PRIORITIES) ? priority
+			: CONFIG_OS_EVENT_NB_PRIORITIES - 1;
+}
+
 /*!
  * \}
  */
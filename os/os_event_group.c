@@ -0,0 +1,130 @@
+/*! \file
+ * \brief eeOS Event Groups
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+/*! \brief Check if the condition of a wait is met
+ * \param flags The flags of the group
+ * \param mask The flags to wait for
+ * \param options The wait options (\ref os_event_group_option)
+ * \return true if the condition is met, false otherwise.
+ */
+static inline bool __os_event_group_is_met(uint32_t flags, uint32_t mask,
+		uint8_t options) {
+	if (options & OS_EVENT_GROUP_WAIT_ALL) {
+		return ((flags & mask) == mask);
+	}
+	return (flags & mask) ? true : false;
+}
+
+uint32_t os_event_group_set(struct os_event_group *group, uint32_t flags)
+{
+	struct os_queue_event_group **elt_ptr;
+	struct os_queue_event_group *elt;
+	uint32_t clear = 0;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	group->flags |= flags;
+	flags = group->flags;
+	/* Wake up all the waiters which condition is met. The flags are
+	 * cleared only once all of them have been tested, so that they all see
+	 * the same flags.
+	 */
+	elt_ptr = &group->queue;
+	while ((elt = *elt_ptr) != NULL) {
+		if (__os_event_group_is_met(flags, elt->mask, elt->options)) {
+			/* Remove the waiter from the list */
+			*elt_ptr = elt->next;
+			elt->flags = flags & elt->mask;
+			if (elt->options & OS_EVENT_GROUP_CLEAR_ON_EXIT) {
+				clear |= elt->mask;
+			}
+			__os_process_enable_naked(elt->proc);
+		}
+		else {
+			elt_ptr = &elt->next;
+		}
+	}
+	group->flags &= ~clear;
+	flags = group->flags;
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return flags;
+}
+
+uint32_t os_event_group_clear(struct os_event_group *group, uint32_t flags)
+{
+	uint32_t previous;
+	bool is_critical = os_is_critical();
+
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	previous = group->flags;
+	group->flags = previous & ~flags;
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return previous;
+}
+
+uint32_t os_event_group_wait(struct os_event_group *group, uint32_t mask,
+		enum os_event_group_option options)
+{
+	/* Waiter record, it lives on the stack until the process wakes up */
+	struct os_queue_event_group queue_elt;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* If the condition is already met, do not wait */
+	if (__os_event_group_is_met(group->flags, mask, options)) {
+		queue_elt.flags = group->flags & mask;
+		if (options & OS_EVENT_GROUP_CLEAR_ON_EXIT) {
+			group->flags &= ~mask;
+		}
+	}
+	/* Else suspend this task until the flags are set */
+	else {
+		/* Disable this process */
+		__os_process_disable_naked(__os_process_get_current());
+		/* Fill the waiter record */
+		queue_elt.proc = __os_process_get_current();
+		queue_elt.mask = mask;
+		queue_elt.options = options;
+		/* Add this process to the waiting list of the group */
+		os_queue_process_add((struct os_queue_process **) &group->queue,
+				(struct os_queue_process *) &queue_elt);
+		/* Manually switch the process context */
+		os_switch_context(false);
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return queue_elt.flags;
+}
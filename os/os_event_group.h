@@ -0,0 +1,151 @@
+/*! \file
+ * \brief eeOS Event Groups
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_EVENT_GROUP_H__
+#define __OS_EVENT_GROUP_H__
+
+/*! \addtogroup group_os
+ * \section section_os_event_group Event Groups
+ *
+ * An event group (\ref os_event_group) holds a word of 32 flags. Processes can
+ * wait until any (\ref OS_EVENT_GROUP_WAIT_ANY) or all
+ * (\ref OS_EVENT_GROUP_WAIT_ALL) of the flags of a mask are set.
+ * \code
+ * #define FLAG_RX (1 << 0)
+ * #define FLAG_TX (1 << 1)
+ * struct os_event_group my_group;
+ * os_event_group_create(&my_group, 0);
+ * // In a task
+ * flags = os_event_group_wait(&my_group, FLAG_RX | FLAG_TX,
+ *		OS_EVENT_GROUP_WAIT_ANY | OS_EVENT_GROUP_CLEAR_ON_EXIT);
+ * // In an interrupt
+ * os_event_group_set(&my_group, FLAG_RX);
+ * \endcode
+ *
+ * Compared to a sleep on multiple events (\ref os_task_sleep), a single waiter
+ * record covers the whole mask, and it does not involve the event process:
+ * the waiters are tested with a bitwise operation directly when the flags are
+ * set.
+ */
+
+/* Types **********************************************************************/
+
+/*! \brief Options of \ref os_event_group_wait. They can be combined.
+ */
+enum os_event_group_option {
+	/*! \brief Wait until at least one of the flags of the mask is set
+	 */
+	OS_EVENT_GROUP_WAIT_ANY = 0,
+	/*! \brief Wait until all the flags of the mask are set
+	 */
+	OS_EVENT_GROUP_WAIT_ALL = 1,
+	/*! \brief Clear the flags of the mask which are set, when the wait is
+	 * over
+	 */
+	OS_EVENT_GROUP_CLEAR_ON_EXIT = 2,
+};
+
+/*! \struct os_queue_event_group
+ * \brief Waiter record of an event group (see \ref OS_QUEUE_DEFINE for more
+ * details). It is allocated on the stack of the waiting process.
+ */
+OS_QUEUE_DEFINE(event_group,
+	/*! \brief The waiting process. It must be the first member, to be
+	 * sorted as a \ref os_queue_process.
+	 */
+	struct os_process *proc;
+	/*! \brief Flags the process is waiting for */
+	uint32_t mask;
+	/*! \brief Options of the wait (\ref os_event_group_option) */
+	uint8_t options;
+	/*! \brief Flags of the mask which were set when the process has been
+	 * waken up
+	 */
+	volatile uint32_t flags;
+);
+
+/*! \brief Event group structure
+ */
+struct os_event_group {
+	/*! \brief The flags of the group
+	 */
+	volatile uint32_t flags;
+	/*! \brief Processes waiting on the group, sorted by priority
+	 */
+	struct os_queue_event_group *queue;
+};
+
+/* Public API *****************************************************************/
+
+/*! \name Event Groups
+ *
+ * Set of functions to create and control event groups
+ *
+ * \{
+ */
+
+/*! \brief Creates an event group
+ * \ingroup group_os_public_api
+ * \param group The un-initialized event group structure
+ * \param flags The initial value of the flags
+ */
+static inline void os_event_group_create(struct os_event_group *group,
+		uint32_t flags) {
+	group->flags = flags;
+	group->queue = NULL;
+}
+
+/*! \brief Set flags of an event group, and wake up the processes which wait
+ * for them. This function can be called from an interrupt.
+ * \ingroup group_os_public_api
+ * \param group The event group
+ * \param flags The flags to set
+ * \return The flags of the group once the waiters have been waken up (and
+ * some flags possibly cleared, see \ref OS_EVENT_GROUP_CLEAR_ON_EXIT).
+ */
+uint32_t os_event_group_set(struct os_event_group *group, uint32_t flags);
+
+/*! \brief Clear flags of an event group
+ * \ingroup group_os_public_api
+ * \param group The event group
+ * \param flags The flags to clear
+ * \return The flags of the group before they are cleared
+ */
+uint32_t os_event_group_clear(struct os_event_group *group, uint32_t flags);
+
+/*! \brief Get the flags of an event group
+ * \ingroup group_os_public_api
+ * \param group The event group
+ * \return The current flags of the group
+ */
+static inline uint32_t os_event_group_get(struct os_event_group *group) {
+	return group->flags;
+}
+
+/*! \brief Wait for flags of an event group. If the condition is already met,
+ * this function returns immediately.
+ * \ingroup group_os_public_api
+ * \param group The event group
+ * \param mask The flags to wait for
+ * \param options The wait options (\ref os_event_group_option)
+ * \return The flags of the mask which are set when the condition is met.
+ */
+uint32_t os_event_group_wait(struct os_event_group *group, uint32_t mask,
+		enum os_event_group_option options);
+
+/*!
+ * \}
+ */
+
+#endif // __OS_EVENT_GROUP_H__
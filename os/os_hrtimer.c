@@ -0,0 +1,213 @@
+/*! \file
+ * \brief eeOS High-Resolution Timers
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+#if CONFIG_OS_USE_HRTIMER == true
+
+/*! \brief Min-heap of the armed timers, ordered by deadline.
+ */
+static struct os_hrtimer *__os_hrtimer_heap[CONFIG_OS_HRTIMER_MAX];
+
+/*! \brief Number of armed timers
+ */
+static int __os_hrtimer_nb = 0;
+
+/*! \brief Compare 2 deadlines. The cycle counter wraps, so only the difference
+ * is meaningful.
+ * \return true if \b a is before \b b
+ */
+static inline bool __os_hrtimer_is_before(os_cy_t a, os_cy_t b)
+{
+	return ((int32_t) (a - b) < 0);
+}
+
+/*! \brief Store a timer at a given position of the heap
+ */
+static inline void __os_hrtimer_heap_set(int index, struct os_hrtimer *timer)
+{
+	__os_hrtimer_heap[index] = timer;
+	timer->index = index;
+}
+
+/*! \brief Move a timer up or down the heap to its place
+ * \param index The current position of the timer
+ * \warning This function must be called inside a critical section.
+ */
+static void __os_hrtimer_heap_update(int index)
+{
+	struct os_hrtimer *timer = __os_hrtimer_heap[index];
+	int child;
+
+	/* Move it up while it is earlier than its parent */
+	while (index && __os_hrtimer_is_before(timer->when,
+			__os_hrtimer_heap[(index - 1) / 2]->when)) {
+		__os_hrtimer_heap_set(index, __os_hrtimer_heap[(index - 1) / 2]);
+		index = (index - 1) / 2;
+	}
+	/* Move it down while one of its children is earlier */
+	while ((child = 2 * index + 1) < __os_hrtimer_nb) {
+		if (child + 1 < __os_hrtimer_nb && __os_hrtimer_is_before(
+				__os_hrtimer_heap[child + 1]->when,
+				__os_hrtimer_heap[child]->when)) {
+			child++;
+		}
+		if (!__os_hrtimer_is_before(__os_hrtimer_heap[child]->when,
+				timer->when)) {
+			break;
+		}
+		__os_hrtimer_heap_set(index, __os_hrtimer_heap[child]);
+		index = child;
+	}
+	__os_hrtimer_heap_set(index, timer);
+}
+
+/*! \brief Remove an armed timer from the heap
+ * \param timer The timer
+ * \warning This function must be called inside a critical section.
+ */
+static void __os_hrtimer_heap_remove(struct os_hrtimer *timer)
+{
+	int index = timer->index;
+
+	timer->index = -1;
+	/* Replace it with the last timer of the heap */
+	if (index != --__os_hrtimer_nb) {
+		__os_hrtimer_heap_set(index, __os_hrtimer_heap[__os_hrtimer_nb]);
+		__os_hrtimer_heap_update(index);
+	}
+}
+
+/*! \brief Program the compare unit with the first deadline
+ * \warning This function must be called inside a critical section.
+ */
+static inline void __os_hrtimer_program(void)
+{
+	if (__os_hrtimer_nb) {
+		os_set_hrtimer_alarm(true, __os_hrtimer_heap[0]->when);
+	}
+	else {
+		os_set_hrtimer_alarm(false, 0);
+	}
+}
+
+bool __os_hrtimer_int_handler(void)
+{
+	struct os_hrtimer *timer;
+
+	/* Run the handlers of the expired timers. A handler can re-arm its
+	 * timer, it will then be processed again if already expired.
+	 */
+	while (__os_hrtimer_nb && !__os_hrtimer_is_before(os_read_hrtimer(),
+			__os_hrtimer_heap[0]->when)) {
+		timer = __os_hrtimer_heap[0];
+		__os_hrtimer_heap_remove(timer);
+		timer->handler(timer->args);
+	}
+	__os_hrtimer_program();
+
+	return os_hrtimer_is_tick();
+}
+
+void os_hrtimer_create(struct os_hrtimer *timer, os_proc_ptr_t handler,
+		os_ptr_t args)
+{
+	timer->handler = handler;
+	timer->args = args;
+	timer->index = -1;
+}
+
+bool os_hrtimer_start_at(struct os_hrtimer *timer, os_cy_t when)
+{
+	/* Check if the current process is running inside a critical region. */
+	bool is_critical = os_is_critical();
+	/* The following code is critical, so enter in the critial region if
+	 * not already done.
+	 */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Restart the timer if it is already armed */
+	if (timer->index < 0) {
+		if (__os_hrtimer_nb == CONFIG_OS_HRTIMER_MAX) {
+			if (!is_critical) {
+				os_leave_critical();
+			}
+			return false;
+		}
+		__os_hrtimer_heap_set(__os_hrtimer_nb++, timer);
+	}
+	timer->when = when;
+	__os_hrtimer_heap_update(timer->index);
+	/* Re-program the compare unit only if the first deadline changed */
+	if (__os_hrtimer_heap[0] == timer) {
+		__os_hrtimer_program();
+	}
+	/* Leave the critical region if the process was not previously in. */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+	return true;
+}
+
+bool os_hrtimer_start(struct os_hrtimer *timer, os_cy_t delay)
+{
+	bool is_critical = os_is_critical();
+	bool ret;
+
+	/* The time must be read within the same critical region */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	ret = os_hrtimer_start_at(timer, os_read_hrtimer() + delay);
+	if (!is_critical) {
+		os_leave_critical();
+	}
+	return ret;
+}
+
+void os_hrtimer_stop(struct os_hrtimer *timer)
+{
+	bool is_critical = os_is_critical();
+
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* The compare unit is not re-programmed, the next match will just
+	 * have nothing to run.
+	 */
+	if (timer->index >= 0) {
+		__os_hrtimer_heap_remove(timer);
+	}
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+os_cy_t os_hrtimer_now(void)
+{
+	bool is_critical = os_is_critical();
+	os_cy_t now;
+
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	now = os_read_hrtimer();
+	if (!is_critical) {
+		os_leave_critical();
+	}
+	return now;
+}
+
+#endif
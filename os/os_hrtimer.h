@@ -0,0 +1,206 @@
+/*! \file
+ * \brief eeOS High-Resolution Timers
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_HRTIMER_H__
+#define __OS_HRTIMER_H__
+
+/*! \addtogroup group_os
+ * \section section_os_hrtimer High-Resolution Timers
+ *
+ * A high-resolution timer (\ref os_hrtimer) calls a handler at a given cycle
+ * of the CPU, from the interrupt context. It is meant for drivers which need
+ * cycle-accurate events, such as the edges of a bit-banged protocol, without
+ * using a dedicated hardware timer.
+ *
+ * All the high-resolution timers share the compare unit which generates the
+ * ticks (\ref CONFIG_OS_SCHEDULER_USE_COMPARE). The armed timers are kept in a
+ * min-heap ordered by deadline, and the compare unit is always programmed with
+ * the earliest of the next tick and the first deadline. An interrupt which
+ * is not a tick only runs the expired handlers and returns to the interrupted
+ * process, without calling the scheduler.
+ *
+ * \code
+ * static void my_edge(os_ptr_t args);
+ * struct os_hrtimer my_hrtimer;
+ * os_hrtimer_create(&my_hrtimer, my_edge, NULL);
+ * os_hrtimer_start(&my_hrtimer, os_hrtimer_us_to_cy(25));
+ * \endcode
+ *
+ * The deadlines are expressed in CPU cycles (\ref os_hrtimer_now), on 32 bits.
+ * A deadline must therefore be less than 2^31 cycles ahead. A handler can
+ * re-arm its own timer, relatively to its previous deadline, to generate
+ * periodic events without drift.
+ *
+ * \note The port needs at least \ref CONFIG_OS_HRTIMER_MIN_CY cycles to
+ * program the compare unit. A deadline closer than that is delayed
+ * accordingly.
+ */
+
+/* Configuration options ******************************************************/
+
+/*! \def CONFIG_OS_USE_HRTIMER
+ * \brief Use this option to enable the high-resolution timers support.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_SCHEDULER_TYPE must be
+ * \ref CONFIG_OS_SCHEDULER_USE_COMPARE.
+ */
+#ifndef CONFIG_OS_USE_HRTIMER
+	#define CONFIG_OS_USE_HRTIMER false
+#endif
+#if CONFIG_OS_USE_HRTIMER == true && \
+		CONFIG_OS_SCHEDULER_TYPE != CONFIG_OS_SCHEDULER_USE_COMPARE
+	#error The high-resolution timers share the compare unit with the\
+			scheduler. CONFIG_OS_SCHEDULER_TYPE must be set to\
+			CONFIG_OS_SCHEDULER_USE_COMPARE.
+#endif
+
+/*! \def CONFIG_OS_HRTIMER_MAX
+ * \brief Maximum number of high-resolution timers armed at the same time. It
+ * defines the size of the heap.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_HRTIMER needs to be set
+ */
+#ifndef CONFIG_OS_HRTIMER_MAX
+	#define CONFIG_OS_HRTIMER_MAX 8
+#endif
+
+/*! \def CONFIG_OS_HRTIMER_MIN_CY
+ * \brief Minimum number of cycles between the programming of the compare unit
+ * and its match. It must cover the time needed by the port to program it.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_HRTIMER needs to be set
+ */
+#ifndef CONFIG_OS_HRTIMER_MIN_CY
+	#define CONFIG_OS_HRTIMER_MIN_CY 64
+#endif
+
+/* Types **********************************************************************/
+
+#if CONFIG_OS_USE_HRTIMER == true
+/*! \brief High-resolution timer
+ */
+struct os_hrtimer {
+	/*! \brief Deadline in CPU cycles
+	 */
+	os_cy_t when;
+	/*! \brief Function called from the interrupt context when the timer
+	 * expires
+	 */
+	os_proc_ptr_t handler;
+	/*! \brief Arguments passed to the handler
+	 */
+	os_ptr_t args;
+	/*! \brief Position of the timer in the heap, -1 if it is not armed
+	 */
+	int index;
+};
+#endif
+
+/* Internal API ***************************************************************/
+
+#if CONFIG_OS_USE_HRTIMER == true
+/*! \brief Handle an interrupt of the compare unit. It runs the handlers of the
+ * expired timers and programs the next match.
+ * \ingroup group_os_internal_api
+ * \return true if this interrupt is a tick, false otherwise.
+ * \warning This function must be called from the tick interrupt.
+ */
+bool __os_hrtimer_int_handler(void);
+#endif
+
+/* Public API *****************************************************************/
+
+#if CONFIG_OS_USE_HRTIMER == true
+/*! \name High-Resolution Timers
+ *
+ * Set of functions to manage high-resolution timers
+ *
+ * \{
+ */
+
+/*! \brief Create a high-resolution timer. The timer is stopped.
+ * \ingroup group_os_public_api
+ * \param timer The timer to be initialized
+ * \param handler The function to call when the timer expires. It runs from
+ * the interrupt context, so it must be short and must not block.
+ * \param args Arguments passed to the handler
+ * \pre \ref CONFIG_OS_USE_HRTIMER needs to be set
+ */
+void os_hrtimer_create(struct os_hrtimer *timer, os_proc_ptr_t handler,
+		os_ptr_t args);
+
+/*! \brief Start (or restart) a timer at an absolute deadline
+ * \ingroup group_os_public_api
+ * \param timer The timer
+ * \param when The deadline in CPU cycles (see \ref os_hrtimer_now)
+ * \return true if the timer is armed, false if too many timers are armed
+ * already (\ref CONFIG_OS_HRTIMER_MAX).
+ * \pre \ref CONFIG_OS_USE_HRTIMER needs to be set
+ */
+bool os_hrtimer_start_at(struct os_hrtimer *timer, os_cy_t when);
+
+/*! \brief Start (or restart) a timer relatively to the current time
+ * \ingroup group_os_public_api
+ * \param timer The timer
+ * \param delay The number of CPU cycles before the timer expires
+ * \return true if the timer is armed, false if too many timers are armed
+ * already (\ref CONFIG_OS_HRTIMER_MAX).
+ * \pre \ref CONFIG_OS_USE_HRTIMER needs to be set
+ */
+bool os_hrtimer_start(struct os_hrtimer *timer, os_cy_t delay);
+
+/*! \brief Stop a timer. Its handler will not be called.
+ * \ingroup group_os_public_api
+ * \param timer The timer
+ * \pre \ref CONFIG_OS_USE_HRTIMER needs to be set
+ */
+void os_hrtimer_stop(struct os_hrtimer *timer);
+
+/*! \brief Check if a timer is armed
+ * \ingroup group_os_public_api
+ * \param timer The timer
+ * \return true if the timer is armed, false otherwise.
+ * \pre \ref CONFIG_OS_USE_HRTIMER needs to be set
+ */
+static inline bool os_hrtimer_is_active(struct os_hrtimer *timer) {
+	return (timer->index >= 0);
+}
+
+/*! \brief Get the current time in CPU cycles. This counter wraps, so only
+ * differences between 2 values are meaningful.
+ * \ingroup group_os_public_api
+ * \return The current time in CPU cycles
+ * \pre \ref CONFIG_OS_USE_HRTIMER needs to be set
+ */
+os_cy_t os_hrtimer_now(void);
+
+/*! \brief Convert microseconds into CPU cycles
+ * \ingroup group_os_public_api
+ * \param time_us The time in microseconds
+ * \return The number of CPU cycles
+ * \pre \ref CONFIG_OS_USE_HRTIMER needs to be set
+ */
+static inline os_cy_t os_hrtimer_us_to_cy(uint32_t time_us) {
+	/* Number of cycles per tick (1 / CONFIG_OS_TICK_HZ) */
+	uint64_t cy_per_tick = os_get_tick_timer_top() / __os_tick_get_step();
+	return (os_cy_t) (((uint64_t) time_us * cy_per_tick * CONFIG_OS_TICK_HZ)
+			/ 1000000UL);
+}
+
+/*!
+ * \}
+ */
+#endif
+
+#endif // __OS_HRTIMER_H__
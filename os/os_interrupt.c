@@ -25,6 +25,15 @@ void __os_interrupt_handler(os_ptr_t args)
 	__os_process_disable_naked(__os_interrupt_get_process(interrupt));
 	/* Execute the interrupt handler */
 	interrupt->int_ptr(interrupt->args);
+#if CONFIG_OS_USE_EVENTS == true
+	/* Wait for the next occurrence of the event it is attached to, unless
+	 * the handler has already attached it to a new event.
+	 */
+	if (interrupt->event && !__os_process_is_pending(
+			__os_interrupt_get_process(interrupt))) {
+		__os_interrupt_event_register(interrupt);
+	}
+#endif
 	/* Manually call the scheduler */
 	os_switch_context(true);
 }
@@ -40,6 +49,10 @@ void os_interrupt_create(struct os_interrupt *interrupt, os_proc_ptr_t int_ptr,
 	/* Fill the structure */
 	interrupt->int_ptr = int_ptr;
 	interrupt->args = args;
+#if CONFIG_OS_USE_EVENTS == true
+	interrupt->event = NULL;
+	interrupt->event_triggered = NULL;
+#endif
 	/* Set default priority for the interrupt */
 #if CONFIG_OS_USE_PRIORITY == true
 	os_interrupt_set_priority(interrupt,
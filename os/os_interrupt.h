@@ -21,6 +21,12 @@
  * A software interrupt (\ref os_interrupt) is a process which will not be
  * interrupted by the process scheduler. An interrupt uses the same stack as the
  * application process.
+ *
+ * A software interrupt can be attached to an event
+ * (\ref os_interrupt_trigger_on_event). Its handler then runs each time the
+ * event triggers, until it is detached (\ref os_interrupt_detach_event).
+ * This replaces a task looping on \ref os_task_sleep, without the need of a
+ * dedicated stack.
  */
 
 /* Configuration options ******************************************************/
@@ -81,6 +87,17 @@ struct os_interrupt {
 	/*! \brief Arguments to pass to the interrupt handler
 	 */
 	os_ptr_t args;
+#if CONFIG_OS_USE_EVENTS == true
+	/*! \brief Event the interrupt is attached to, NULL if none
+	 */
+	struct os_event *event;
+	/*! \brief Entry of the interrupt in the process list of its event
+	 */
+	struct os_queue_event queue_elt;
+	/*! \brief Event which has triggered the interrupt
+	 */
+	struct os_event *event_triggered;
+#endif
 };
 
 /* Internal API ***************************************************************/
@@ -111,6 +128,23 @@ static inline struct os_process *__os_interrupt_get_process(
  */
 void __os_interrupt_handler(os_ptr_t args);
 
+#if CONFIG_OS_USE_EVENTS == true
+/*! \brief Register a software interrupt to the event it is attached to, so
+ * that it is triggered the next time this event triggers.
+ * \ingroup group_os_internal_api
+ * \param interrupt The interrupt, it must not be enabled.
+ * \warning This function must be called inside a critical section
+ */
+void __os_interrupt_event_register(struct os_interrupt *interrupt);
+
+/*! \brief Trigger a software interrupt, cancelling its entry in the active
+ * event list if it is waiting for the event it is attached to.
+ * \ingroup group_os_internal_api
+ * \param interrupt The interrupt
+ */
+void __os_interrupt_trigger(struct os_interrupt *interrupt);
+#endif
+
 /* Public API *****************************************************************/
 
 /*! \name Software Interrupts
@@ -136,14 +170,19 @@ void __os_interrupt_handler(os_ptr_t args);
 void os_interrupt_create(struct os_interrupt *interrupt, os_proc_ptr_t int_ptr,
 		os_ptr_t args);
 
-/*! \brief Manually trigger a software interrupt.
+/*! \brief Manually trigger a software interrupt. If it is attached to an
+ * event, it waits for this event again once its handler has been executed.
  * \ingroup group_os_public_api
  * \param interrupt The interrupt to trigger
  * \pre The interrupt must be previously setup with \ref os_interrupt_create
  */
 static inline void os_interrupt_trigger(struct os_interrupt *interrupt) {
 	__HOOK_OS_DEBUG_TRACE_LOG(OS_DEBUG_TRACE_INTERRUPT_TRIGGER, interrupt);
+#if CONFIG_OS_USE_EVENTS == true
+	__os_interrupt_trigger(interrupt);
+#else
 	__os_process_enable(__os_interrupt_get_process(interrupt));
+#endif
 }
 
 #if CONFIG_OS_USE_PRIORITY == true
@@ -178,7 +217,10 @@ static inline enum os_priority os_interrupt_get_priority(
 #endif
 
 #if CONFIG_OS_USE_EVENTS == true
-/*! \brief Trigger an interrupt on a specific event
+/*! \brief Trigger an interrupt on a specific event. The interrupt stays
+ * attached to this event, it will be triggered each time the event triggers.
+ * If the interrupt was attached to another event, it is detached from it
+ * first.
  * \ingroup group_os_public_api
  * \param interrupt The interrupt to wakeup
  * \param event The event used to trigger the interrupt
@@ -186,6 +228,26 @@ static inline enum os_priority os_interrupt_get_priority(
  */
 void os_interrupt_trigger_on_event(struct os_interrupt *interrupt,
 		struct os_event *event);
+
+/*! \brief Detach an interrupt from its event
+ * \ingroup group_os_public_api
+ * \param interrupt The interrupt
+ * \pre \ref CONFIG_OS_USE_EVENTS needs to be set
+ */
+void os_interrupt_detach_event(struct os_interrupt *interrupt);
+
+/*! \brief Get the event which has triggered an interrupt. It can be called
+ * from the interrupt handler.
+ * \ingroup group_os_public_api
+ * \param interrupt The interrupt
+ * \return The event, or NULL if the interrupt has not been triggered by an
+ * event.
+ * \pre \ref CONFIG_OS_USE_EVENTS needs to be set
+ */
+static inline struct os_event *os_interrupt_get_event(
+		struct os_interrupt *interrupt) {
+	return interrupt->event_triggered;
+}
 #endif
 
 /*!
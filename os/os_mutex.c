@@ -29,11 +29,9 @@ enum os_event_status __os_event_mutex_is_triggered(struct os_process *proc,
 		os_enter_critical();
 	}
 	/* Test if the mutex is not locked */
-	if (!mutex->is_locked) {
-		/* lock it */
-		mutex->is_locked = true;
-		/* Associate a process with this mutex */
-		mutex->process = proc;
+	if (!__os_mutex_is_locked(mutex)) {
+		/* Lock it and associate a process with this mutex */
+		__os_mutex_acquire(mutex, proc);
 		/* Set the status of this event to triggered */
 		status = OS_EVENT_OK_STOP;
 	}
@@ -49,27 +47,35 @@ enum os_event_status __os_event_mutex_is_triggered(struct os_process *proc,
 void os_mutex_lock(struct os_mutex *mutex)
 {
 	/* Save the critical region status */
-	bool is_critical = os_is_critical();
+	bool is_critical;
 
+#if CONFIG_OS_USE_ATOMIC == true
+	/* If the mutex is free, lock it without masking the interrupts */
+	if (__os_mutex_is_lock_free(mutex) && os_atomic_cas(&mutex->state, 0,
+			(os_reg_t) (os_intptr_t) __os_process_get_current())) {
+		return;
+	}
+#endif
+	is_critical = os_is_critical();
 	/* Enter in a critical region if not already in */
 	if (!is_critical) {
 		os_enter_critical();
 	}
 	/* If the mutex is not locked, lock it */
-	if (!mutex->is_locked) {
-		mutex->is_locked = true;
-		mutex->process = __os_process_get_current();
+	if (!__os_mutex_is_locked(mutex)) {
+		__os_mutex_acquire(mutex, __os_process_get_current());
 	}
 	/* If the mutex is already locked, suspend this task */
 	else {
 		/* Create a queue element, it will be stored on the stack. */
-		struct os_queue_process queue_elt;
+		struct os_wait_queue_elt queue_elt;
+		/* The owner will have to wake it up */
+		mutex->state |= __OS_MUTEX_WAITERS;
 		/* Disable this process */
 		__os_process_disable_naked(__os_process_get_current());
-		/* Set the data associated to this queue entry */
-		queue_elt.proc = __os_process_get_current();
-		/* Add this process to the event list of the mutex */
-		os_queue_process_add(&mutex->queue, &queue_elt);
+		/* Add this process to the waiting list of the mutex */
+		os_wait_queue_add(&mutex->queue, &queue_elt,
+				__os_process_get_current());
 		/* Manually switch the process context */
 		os_switch_context(false);
 	}
@@ -82,26 +88,38 @@ void os_mutex_lock(struct os_mutex *mutex)
 void os_mutex_unlock(struct os_mutex *mutex)
 {
 	/* Only the process which locked the mutex can unlock it */
-	if (__os_process_get_current() == mutex->process) {
+	if (__os_process_get_current() == __os_mutex_get_owner(mutex)) {
 		/* Save the critical region status */
-		bool is_critical = os_is_critical();
+		bool is_critical;
+#if CONFIG_OS_USE_ATOMIC == true
+		/* If nobody waits for the mutex, unlock it without masking the
+		 * interrupts
+		 */
+		if (__os_mutex_is_lock_free(mutex) && os_atomic_cas(&mutex->state,
+				(os_reg_t) (os_intptr_t) __os_process_get_current(), 0)) {
+			return;
+		}
+#endif
+		is_critical = os_is_critical();
 		/* Enter in a critical region if not already in */
 		if (!is_critical) {
 			os_enter_critical();
 		}
+		/* Drop the ceiling priority if any */
+		__os_mutex_release(mutex);
 		/* Check if there is another process in the waiting list */
-		if (mutex->queue) {
+		if (!os_wait_queue_is_empty(&mutex->queue)) {
 			struct os_process *proc;
 			/* Pop the next process in the waiting list */
-			proc = os_queue_process_pop(&mutex->queue)->proc;
+			proc = os_wait_queue_pop(&mutex->queue)->proc;
 			/* Lock the mutex for this process */
-			mutex->process = proc;
+			__os_mutex_acquire(mutex, proc);
 			/* Enable this process */
 			__os_process_enable_naked(proc);
 		}
 		/* Else unlock the mutex */
 		else {
-			mutex->is_locked = false;
+			mutex->state = 0;
 		}
 		/* Leave the critical region unless the CPU was previously in */
 		if (!is_critical) {
@@ -15,20 +15,64 @@
 #ifndef __OS_MUTEX_H__
 #define __OS_MUTEX_H__
 
+/*! \addtogroup group_os
+ * \section section_os_mutex Mutex
+ *
+ * A mutex (\ref os_mutex) protects a resource shared between processes. Only
+ * the process which has locked a mutex can unlock it.
+ *
+ * If priorities are enabled, a mutex can be given a ceiling priority
+ * (\ref os_mutex_create_ceiling), which is the highest priority of the
+ * processes using it. The process which locks such a mutex runs at the
+ * ceiling priority straight away, until it unlocks it (immediate priority
+ * ceiling protocol). A low priority process holding the resource then cannot
+ * be delayed by the processes of intermediate priority, which bounds the
+ * time the processes of higher priority can be blocked by it. Ceiling mutexes
+ * must be unlocked in the reverse order of their locking. While a task holds
+ * the ceiling, the schedulability analysis (\ref section_os_schedulability)
+ * accounts for it at the ceiling priority.
+ *
+ * Locking or unlocking a mutex nobody waits for does not go through the
+ * waiting list, with or without a ceiling. If \ref CONFIG_OS_USE_ATOMIC is
+ * set, it does not mask the interrupts either, unless the mutex has a
+ * ceiling.
+ */
+
+/* Macros *********************************************************************/
+
+/*! \brief Flag of \ref os_mutex::state set while processes are in the waiting
+ * list. The owner then has to unlock the mutex through the slow path.
+ */
+#define __OS_MUTEX_WAITERS 1
+
+#if CONFIG_OS_USE_PRIORITY == true
+/*! \brief Value of \ref os_mutex::ceiling for a mutex without ceiling
+ */
+#define __OS_MUTEX_NO_CEILING 0xff
+#endif
+
 /* Types **********************************************************************/
 
 /*! \brief Mutex Structure
  */
 struct os_mutex {
-	/*! \brief Defines if a mutex is locked or not
-	 */
-	bool is_locked;
-	/*! \brief The process which locked the mutex
+	/*! \brief The process which locked the mutex, or 0 if it is not
+	 * locked, combined with \ref __OS_MUTEX_WAITERS. It is a single word so
+	 * that it can be updated atomically.
 	 */
-	struct os_process *process;
+	volatile os_reg_t state;
 	/*! \brief Next processes on the waiting list
 	 */
-	struct os_queue_process *queue;
+	struct os_wait_queue queue;
+#if CONFIG_OS_USE_PRIORITY == true
+	/*! \brief Ceiling priority of the mutex, \ref __OS_MUTEX_NO_CEILING
+	 * if none
+	 */
+	uint8_t ceiling;
+	/*! \brief Priority of the owner before it has locked the mutex
+	 */
+	uint8_t owner_priority;
+#endif
 };
 
 /* Internal API ***************************************************************/
@@ -42,6 +86,100 @@ struct os_mutex {
 enum os_event_status __os_event_mutex_is_triggered(struct os_process *proc,
 		os_ptr_t args);
 
+/*! \brief Check if a mutex is locked
+ * \ingroup group_os_internal_api
+ * \param mutex The mutex
+ * \return true if it is locked, false otherwise.
+ */
+static inline bool __os_mutex_is_locked(struct os_mutex *mutex) {
+	return (mutex->state != 0);
+}
+
+/*! \brief Get the process which has locked a mutex
+ * \ingroup group_os_internal_api
+ * \param mutex The mutex
+ * \return The owner of the mutex, NULL if it is not locked.
+ */
+static inline struct os_process *__os_mutex_get_owner(struct os_mutex *mutex) {
+	return (struct os_process *) (os_intptr_t) (mutex->state
+			& ~__OS_MUTEX_WAITERS);
+}
+
+/*! \brief Check if a mutex can be locked and unlocked with the atomic
+ * operations only
+ * \ingroup group_os_internal_api
+ * \param mutex The mutex
+ * \return true if it can, false if it has a ceiling.
+ */
+static inline bool __os_mutex_is_lock_free(struct os_mutex *mutex) {
+#if CONFIG_OS_USE_PRIORITY == true
+	return (mutex->ceiling == __OS_MUTEX_NO_CEILING);
+#else
+	return true;
+#endif
+}
+
+#if CONFIG_OS_USE_PRIORITY == true
+/*! \brief Change the priority of the owner of a ceiling mutex. The priority of
+ * a task goes through the schedulability analysis, so that it stays up to date
+ * while the ceiling is held.
+ * \ingroup group_os_internal_api
+ * \param proc The owner of the mutex
+ * \param priority The new priority
+ * \warning This function must be called inside a critical section
+ */
+static inline void __os_mutex_set_priority(struct os_process *proc,
+		uint8_t priority) {
+#if CONFIG_OS_USE_SCHEDULABILITY == true
+	if (__os_process_is_task(proc)) {
+		__os_schedulability_task_set_priority(
+				__os_task_from_process(proc),
+				(enum os_priority) priority);
+		return;
+	}
+#endif
+	__os_process_set_priority(proc, (enum os_priority) priority);
+}
+#endif
+
+/*! \brief Give a free mutex to a process. If the mutex has a ceiling, the
+ * process is raised to the ceiling priority.
+ * \ingroup group_os_internal_api
+ * \param mutex The mutex
+ * \param proc The new owner of the mutex
+ * \warning This function must be called inside a critical section
+ */
+static inline void __os_mutex_acquire(struct os_mutex *mutex,
+		struct os_process *proc) {
+	mutex->state = (os_reg_t) (os_intptr_t) proc
+			| ((os_wait_queue_is_empty(&mutex->queue)) ? 0
+			: __OS_MUTEX_WAITERS);
+#if CONFIG_OS_USE_PRIORITY == true
+	if (mutex->ceiling != __OS_MUTEX_NO_CEILING) {
+		mutex->owner_priority = proc->priority;
+		if (mutex->ceiling < proc->priority) {
+			__os_mutex_set_priority(proc, mutex->ceiling);
+		}
+	}
+#endif
+}
+
+/*! \brief Take a mutex back from its owner, and restore the priority of the
+ * owner if the mutex has a ceiling. The mutex stays locked.
+ * \ingroup group_os_internal_api
+ * \param mutex The mutex
+ * \warning This function must be called inside a critical section
+ */
+static inline void __os_mutex_release(struct os_mutex *mutex) {
+#if CONFIG_OS_USE_PRIORITY == true
+	struct os_process *proc = __os_mutex_get_owner(mutex);
+	if (mutex->ceiling != __OS_MUTEX_NO_CEILING &&
+			proc->priority != mutex->owner_priority) {
+		__os_mutex_set_priority(proc, mutex->owner_priority);
+	}
+#endif
+}
+
 /* Public API *****************************************************************/
 
 /*! \name Mutex
@@ -56,9 +194,28 @@ enum os_event_status __os_event_mutex_is_triggered(struct os_process *proc,
  * \param mutex The un-initialized mutex structure
  */
 static inline void os_mutex_create(struct os_mutex *mutex) {
-	mutex->is_locked = false;
-	mutex->queue = NULL;
+	mutex->state = 0;
+	os_wait_queue_init(&mutex->queue);
+#if CONFIG_OS_USE_PRIORITY == true
+	mutex->ceiling = __OS_MUTEX_NO_CEILING;
+#endif
+}
+
+#if CONFIG_OS_USE_PRIORITY == true
+/*! \brief Creates a mutex with a ceiling priority (see
+ * \ref section_os_mutex)
+ * \ingroup group_os_public_api
+ * \param mutex The un-initialized mutex structure
+ * \param ceiling The ceiling priority. It must be at least as high as the
+ * priority of every process locking this mutex.
+ * \pre \ref CONFIG_OS_USE_PRIORITY needs to be set
+ */
+static inline void os_mutex_create_ceiling(struct os_mutex *mutex,
+		enum os_priority ceiling) {
+	os_mutex_create(mutex);
+	mutex->ceiling = ceiling;
 }
+#endif
 
 /*! \brief Creates an event from a mutex. The mutex must have been
  * previously created before using this function
@@ -160,3 +160,78 @@ void os_queue_doubly_remove_ex(struct os_queue_doubly **first_elt,
 		os_queue_doubly_remove(elt);
 	}
 }
+
+/*! \brief Get the first element pointer of the level of an element
+ * \param queue The wait queue
+ * \param elt The element
+ * \return The pointer on the first element of its level
+ */
+static inline struct os_wait_queue_elt **__os_wait_queue_first(
+		struct os_wait_queue *queue, struct os_wait_queue_elt *elt) {
+#if CONFIG_OS_USE_PRIORITY == true
+	return &queue->first[elt->level];
+#else
+	return &queue->first;
+#endif
+}
+
+void os_wait_queue_add(struct os_wait_queue *queue,
+		struct os_wait_queue_elt *elt, struct os_process *proc)
+{
+	struct os_wait_queue_elt **first_ptr;
+
+	elt->proc = proc;
+#if CONFIG_OS_USE_PRIORITY == true
+	/* The lowest priority levels share the last level */
+	elt->level = (proc->priority < CONFIG_OS_WAIT_QUEUE_NB_PRIORITIES)
+			? proc->priority : CONFIG_OS_WAIT_QUEUE_NB_PRIORITIES - 1;
+#endif
+	first_ptr = __os_wait_queue_first(queue, elt);
+	elt->next = NULL;
+	/* Append it after the last element of its level */
+	if (*first_ptr) {
+		elt->prev = (*first_ptr)->prev;
+		elt->prev->next = elt;
+		(*first_ptr)->prev = elt;
+	}
+	/* Or it is the only element of its level */
+	else {
+		elt->prev = elt;
+		*first_ptr = elt;
+#if CONFIG_OS_USE_PRIORITY == true
+		queue->mask |= (1UL << elt->level);
+#endif
+	}
+}
+
+void os_wait_queue_remove(struct os_wait_queue *queue,
+		struct os_wait_queue_elt *elt)
+{
+	struct os_wait_queue_elt **first_ptr = __os_wait_queue_first(queue, elt);
+
+	/* If it is the first element of its level */
+	if (*first_ptr == elt) {
+		*first_ptr = elt->next;
+		/* The new first element points on the last one */
+		if (elt->next) {
+			elt->next->prev = elt->prev;
+		}
+#if CONFIG_OS_USE_PRIORITY == true
+		else {
+			queue->mask &= ~(1UL << elt->level);
+		}
+#endif
+	}
+	else {
+		elt->prev->next = elt->next;
+		/* If it is the last element, the first one points on the new
+		 * last one
+		 */
+		if (elt->next) {
+			elt->next->prev = elt->prev;
+		}
+		else {
+			(*first_ptr)->prev = elt->prev;
+		}
+	}
+}
@@ -20,6 +20,23 @@
  * \ingroup group_os_public_api
  */
 
+/* Configuration options ******************************************************/
+
+/*! \def CONFIG_OS_WAIT_QUEUE_NB_PRIORITIES
+ * \brief Number of priority levels of a wait queue (\ref os_wait_queue), up
+ * to 32. The processes which priority is above the last level share the last
+ * level. Each level costs a pointer in every mutex and semaphore.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_PRIORITY needs to be set
+ */
+#ifndef CONFIG_OS_WAIT_QUEUE_NB_PRIORITIES
+	#define CONFIG_OS_WAIT_QUEUE_NB_PRIORITIES 8
+#endif
+#if CONFIG_OS_WAIT_QUEUE_NB_PRIORITIES < 1 || \
+		CONFIG_OS_WAIT_QUEUE_NB_PRIORITIES > 32
+	#error CONFIG_OS_WAIT_QUEUE_NB_PRIORITIES must be between 1 and 32.
+#endif
+
 /* Macros *********************************************************************/
 
 /*! \brief Macro used to define a new singly queue type.
@@ -230,6 +247,43 @@ struct os_queue_doubly {
 typedef bool (*os_queue_doubly_sort_t)(struct os_queue_doubly *a,
 		struct os_queue_doubly *b);
 
+/*! \brief Element of a wait queue (\ref os_wait_queue). It is usually
+ * allocated on the stack of the waiting process.
+ * \ingroup group_os_queue
+ */
+struct os_wait_queue_elt {
+	/*! \brief Next element of the same priority level */
+	struct os_wait_queue_elt *next;
+	/*! \brief Previous element of the same priority level. The first
+	 * element points on the last one.
+	 */
+	struct os_wait_queue_elt *prev;
+	/*! \brief The waiting process */
+	struct os_process *proc;
+#if CONFIG_OS_USE_PRIORITY == true
+	/*! \brief Priority level the element is queued in */
+	uint8_t level;
+#endif
+};
+
+/*! \brief Wait queue. It holds the processes waiting for a resource, with
+ * one FIFO per priority level and a bitmap of the non-empty levels. Adding a
+ * process, popping the one of highest priority or removing any of them is
+ * done in constant time.
+ * \ingroup group_os_queue
+ */
+struct os_wait_queue {
+#if CONFIG_OS_USE_PRIORITY == true
+	/*! \brief First element of each priority level */
+	struct os_wait_queue_elt *first[CONFIG_OS_WAIT_QUEUE_NB_PRIORITIES];
+	/*! \brief Bitmap of the non-empty priority levels */
+	uint32_t mask;
+#else
+	/*! \brief First element of the queue */
+	struct os_wait_queue_elt *first;
+#endif
+};
+
 /* Public API *****************************************************************/
 
 /*! \name Singly Queues
@@ -383,7 +437,10 @@ static inline struct os_queue_doubly *os_queue_doubly_pop(
 		 struct os_queue_doubly **first_elt) {
 	struct os_queue_doubly *elt = *first_elt;
 	*first_elt = elt->next;
-	(*first_elt)->prev = elt->prev;
+	/* Checks if the queue is not empty */
+	if (*first_elt) {
+		(*first_elt)->prev = elt->prev;
+	}
 	return elt;
 }
 
@@ -426,7 +483,10 @@ static inline void os_queue_doubly_insert_first(
 		struct os_queue_doubly *elt) {
 	elt->next = *first_elt;
 	elt->prev = (struct os_queue_doubly *) first_elt;
-	(*first_elt)->prev = elt;
+	/* Checks if the queue was not empty */
+	if (*first_elt) {
+		(*first_elt)->prev = elt;
+	}
 	*first_elt = elt;
 }
 
@@ -530,6 +590,93 @@ static inline void os_queue_process_add(struct os_queue_process **first_elt,
 }
 #endif
 
+/*!
+ * \}
+ */
+
+/*! \name Wait Queues
+ *
+ * Wait queues (\ref os_wait_queue) hold the processes waiting for a resource,
+ * served by priority, then in arrival order.
+ *
+ * \{
+ */
+
+/*! \brief Initialize a wait queue
+ * \ingroup group_os_queue
+ * \param queue The wait queue
+ */
+static inline void os_wait_queue_init(struct os_wait_queue *queue) {
+#if CONFIG_OS_USE_PRIORITY == true
+	int level;
+	for (level = 0; level < CONFIG_OS_WAIT_QUEUE_NB_PRIORITIES; level++) {
+		queue->first[level] = NULL;
+	}
+	queue->mask = 0;
+#else
+	queue->first = NULL;
+#endif
+}
+
+/*! \brief Check if a wait queue is empty
+ * \ingroup group_os_queue
+ * \param queue The wait queue
+ * \return true if it is empty, false otherwise.
+ */
+static inline bool os_wait_queue_is_empty(struct os_wait_queue *queue) {
+#if CONFIG_OS_USE_PRIORITY == true
+	return (queue->mask == 0);
+#else
+	return (queue->first == NULL);
+#endif
+}
+
+/*! \brief Get the element of highest priority of a wait queue, without
+ * removing it
+ * \ingroup group_os_queue
+ * \param queue The wait queue
+ * \return The element, NULL if the queue is empty.
+ */
+static inline struct os_wait_queue_elt *os_wait_queue_head(
+		struct os_wait_queue *queue) {
+#if CONFIG_OS_USE_PRIORITY == true
+	return (queue->mask) ? queue->first[ctz(queue->mask)] : NULL;
+#else
+	return queue->first;
+#endif
+}
+
+/*! \brief Add a process at the end of its priority level
+ * \ingroup group_os_queue
+ * \param queue The wait queue
+ * \param elt The element to be added
+ * \param proc The waiting process
+ */
+void os_wait_queue_add(struct os_wait_queue *queue,
+		struct os_wait_queue_elt *elt, struct os_process *proc);
+
+/*! \brief Remove an element from a wait queue
+ * \ingroup group_os_queue
+ * \param queue The wait queue
+ * \param elt The element, it must be in the queue
+ */
+void os_wait_queue_remove(struct os_wait_queue *queue,
+		struct os_wait_queue_elt *elt);
+
+/*! \brief Remove the element of highest priority from a wait queue
+ * \ingroup group_os_queue
+ * \param queue The wait queue
+ * \return The element, NULL if the queue is empty.
+ */
+static inline struct os_wait_queue_elt *os_wait_queue_pop(
+		struct os_wait_queue *queue) {
+	struct os_wait_queue_elt *elt = os_wait_queue_head(queue);
+	if (elt) {
+		os_wait_queue_remove(queue, elt);
+	}
+	return elt;
+}
+
 /*!
  * \}
  */
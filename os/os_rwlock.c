@@ -0,0 +1,269 @@
+/*! \file
+ * \brief eeOS Reader-Writer Locks
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+/*! \brief Check if a new reader can get the lock straight away
+ * \param lock The lock
+ * \return true if it can, false otherwise.
+ */
+static inline bool __os_rwlock_can_read(struct os_rwlock *lock) {
+	if (lock->is_writing) {
+		return false;
+	}
+	if ((lock->options & OS_RWLOCK_WRITER_PREFERENCE) &&
+			lock->writers_waiting) {
+		return false;
+	}
+	return true;
+}
+
+/*! \brief Check if a writer can get the lock straight away
+ * \param lock The lock
+ * \return true if it can, false otherwise.
+ */
+static inline bool __os_rwlock_can_write(struct os_rwlock *lock) {
+	return (!lock->is_writing && !lock->readers);
+}
+
+/*! \brief Give the lock to a writer
+ * \param lock The lock
+ * \param proc The writer
+ */
+static inline void __os_rwlock_set_writer(struct os_rwlock *lock,
+		struct os_process *proc) {
+	lock->is_writing = true;
+	lock->writer = proc;
+}
+
+/*! \brief Wake up the waiters which can get the lock, in the order of the
+ * waiting list. The readers are waken up together, a writer alone.
+ * \param lock The lock
+ * \warning This function must be called inside a critical section.
+ */
+static void __os_rwlock_wakeup(struct os_rwlock *lock)
+{
+	struct os_queue_rwlock **elt_ptr = &lock->queue;
+	struct os_queue_rwlock *elt;
+
+	while (!lock->is_writing && (elt = *elt_ptr) != NULL) {
+		if (elt->is_writer) {
+			/* Only the first waiter can get it, once the readers have
+			 * left.
+			 */
+			if (!lock->readers) {
+				*elt_ptr = elt->next;
+				lock->writers_waiting--;
+				__os_rwlock_set_writer(lock, elt->proc);
+				__os_process_enable_naked(elt->proc);
+				break;
+			}
+			/* The readers behind a writer wait for it */
+			if (lock->options & OS_RWLOCK_WRITER_PREFERENCE) {
+				break;
+			}
+			elt_ptr = &elt->next;
+		}
+		else {
+			*elt_ptr = elt->next;
+			lock->readers++;
+			__os_process_enable_naked(elt->proc);
+		}
+	}
+}
+
+/*! \brief Suspend the current process until it gets the lock
+ * \param lock The lock
+ * \param is_writer Set if the process waits to write
+ * \warning This function must be called inside a critical section.
+ */
+static void __os_rwlock_wait(struct os_rwlock *lock, bool is_writer)
+{
+	/* Waiter record, it lives on the stack until the process wakes up */
+	struct os_queue_rwlock queue_elt;
+
+	/* Disable this process */
+	__os_process_disable_naked(__os_process_get_current());
+	/* Add this process to the waiting list of the lock */
+	queue_elt.proc = __os_process_get_current();
+	queue_elt.is_writer = is_writer;
+	if (is_writer) {
+		lock->writers_waiting++;
+	}
+	os_queue_process_add((struct os_queue_process **) &lock->queue,
+			(struct os_queue_process *) &queue_elt);
+	/* Manually switch the process context. The lock is held when the
+	 * process resumes.
+	 */
+	os_switch_context(false);
+}
+
+enum os_event_status __os_event_rwlock_read_is_triggered(
+		struct os_process *proc, os_ptr_t args)
+{
+	/* Other readers can be triggered as well */
+	return (os_rwlock_try_read_lock((struct os_rwlock *) args))
+			? OS_EVENT_OK_CONTINUE : OS_EVENT_NONE;
+}
+
+enum os_event_status __os_event_rwlock_write_is_triggered(
+		struct os_process *proc, os_ptr_t args)
+{
+	enum os_event_status status = OS_EVENT_NONE;
+	struct os_rwlock *lock = (struct os_rwlock *) args;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	if (__os_rwlock_can_write(lock)) {
+		__os_rwlock_set_writer(lock, proc);
+		status = OS_EVENT_OK_STOP;
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return status;
+}
+
+bool os_rwlock_try_read_lock(struct os_rwlock *lock)
+{
+	bool is_locked = false;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	if (__os_rwlock_can_read(lock)) {
+		lock->readers++;
+		is_locked = true;
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return is_locked;
+}
+
+void os_rwlock_read_lock(struct os_rwlock *lock)
+{
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	if (__os_rwlock_can_read(lock)) {
+		lock->readers++;
+	}
+	else {
+		__os_rwlock_wait(lock, false);
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+void os_rwlock_read_unlock(struct os_rwlock *lock)
+{
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	if (lock->readers) {
+		lock->readers--;
+		/* The last reader lets a writer in */
+		if (!lock->readers) {
+			__os_rwlock_wakeup(lock);
+		}
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+bool os_rwlock_try_write_lock(struct os_rwlock *lock)
+{
+	bool is_locked = false;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	if (__os_rwlock_can_write(lock)) {
+		__os_rwlock_set_writer(lock, __os_process_get_current());
+		is_locked = true;
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return is_locked;
+}
+
+void os_rwlock_write_lock(struct os_rwlock *lock)
+{
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	if (__os_rwlock_can_write(lock)) {
+		__os_rwlock_set_writer(lock, __os_process_get_current());
+	}
+	else {
+		__os_rwlock_wait(lock, true);
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+void os_rwlock_write_unlock(struct os_rwlock *lock)
+{
+	/* Only the process which locked it can unlock it */
+	if (lock->is_writing && __os_process_get_current() == lock->writer) {
+		/* Save the critical region status */
+		bool is_critical = os_is_critical();
+		/* Enter in a critical region if not already in */
+		if (!is_critical) {
+			os_enter_critical();
+		}
+		lock->is_writing = false;
+		__os_rwlock_wakeup(lock);
+		/* Leave the critical region unless the CPU was previously in */
+		if (!is_critical) {
+			os_leave_critical();
+		}
+	}
+}
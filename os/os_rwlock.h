@@ -0,0 +1,214 @@
+/*! \file
+ * \brief eeOS Reader-Writer Locks
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_RWLOCK_H__
+#define __OS_RWLOCK_H__
+
+/*! \addtogroup group_os
+ * \section section_os_rwlock Reader-Writer Locks
+ *
+ * A reader-writer lock (\ref os_rwlock) lets several processes read a shared
+ * resource at the same time, while a process writing to it has an exclusive
+ * access.
+ * \code
+ * os_rwlock_read_lock(&my_lock);
+ * value = my_table[i];
+ * os_rwlock_read_unlock(&my_lock);
+ * \endcode
+ *
+ * By default, a reader gets the lock as soon as no writer holds it, so a
+ * steady flow of readers can delay a writer forever. With the
+ * \ref OS_RWLOCK_WRITER_PREFERENCE option, a new reader waits as soon as a
+ * writer is waiting, and the readers in the waiting list are not waken up
+ * past a writer.
+ */
+
+/* Types **********************************************************************/
+
+/*! \brief Options of \ref os_rwlock_create
+ */
+enum os_rwlock_option {
+	/*! \brief Readers get the lock whenever no writer holds it
+	 */
+	OS_RWLOCK_DEFAULT = 0,
+	/*! \brief Waiting writers block the new readers
+	 */
+	OS_RWLOCK_WRITER_PREFERENCE = 1,
+};
+
+/*! \struct os_queue_rwlock
+ * \brief Waiter record of a reader-writer lock (see \ref OS_QUEUE_DEFINE for
+ * more details). It is allocated on the stack of the waiting process.
+ */
+OS_QUEUE_DEFINE(rwlock,
+	/*! \brief The waiting process. It must be the first member, to be
+	 * sorted as a \ref os_queue_process.
+	 */
+	struct os_process *proc;
+	/*! \brief Set if the process waits to write */
+	bool is_writer;
+);
+
+/*! \brief Reader-writer lock structure
+ */
+struct os_rwlock {
+	/*! \brief Number of processes currently reading
+	 */
+	volatile uint8_t readers;
+	/*! \brief Number of writers in the waiting list
+	 */
+	uint8_t writers_waiting;
+	/*! \brief Set while a process is writing
+	 */
+	bool is_writing;
+	/*! \brief Options of the lock (\ref os_rwlock_option)
+	 */
+	uint8_t options;
+	/*! \brief The process which is writing
+	 */
+	struct os_process *writer;
+	/*! \brief Processes waiting for the lock, sorted by priority
+	 */
+	struct os_queue_rwlock *queue;
+};
+
+/* Internal API ***************************************************************/
+
+/*! \brief Event trigger function of a reader-writer lock, for reading
+ * \ingroup group_os_internal_api
+ * \param proc The process associated with this event
+ * \param args Extra arguments
+ * \return Returned if the event triggered or not
+ */
+enum os_event_status __os_event_rwlock_read_is_triggered(
+		struct os_process *proc, os_ptr_t args);
+
+/*! \brief Event trigger function of a reader-writer lock, for writing
+ * \ingroup group_os_internal_api
+ * \param proc The process associated with this event
+ * \param args Extra arguments
+ * \return Returned if the event triggered or not
+ */
+enum os_event_status __os_event_rwlock_write_is_triggered(
+		struct os_process *proc, os_ptr_t args);
+
+/* Public API *****************************************************************/
+
+/*! \name Reader-Writer Locks
+ *
+ * Set of functions to create and control reader-writer locks
+ *
+ * \{
+ */
+
+/*! \brief Creates a reader-writer lock
+ * \ingroup group_os_public_api
+ * \param lock The un-initialized lock structure
+ * \param options Options of the lock (\ref os_rwlock_option)
+ */
+static inline void os_rwlock_create(struct os_rwlock *lock,
+		enum os_rwlock_option options) {
+	lock->readers = 0;
+	lock->writers_waiting = 0;
+	lock->is_writing = false;
+	lock->options = options;
+	lock->writer = NULL;
+	lock->queue = NULL;
+}
+
+/*! \brief Creates an event which locks a reader-writer lock for reading. The
+ * lock must have been previously created before using this function.
+ * \ingroup group_os_public_api
+ * \param event The un-initialized event structure
+ * \param lock The lock which will be linked to this event
+ * \pre \ref CONFIG_OS_USE_EVENTS must be set
+ */
+static inline void os_rwlock_create_read_event(struct os_event *event,
+		struct os_rwlock *lock) {
+	const struct os_event_descriptor rwlock_event_descriptor = {
+		.is_triggered = __os_event_rwlock_read_is_triggered
+	};
+	__os_event_create(event, &rwlock_event_descriptor, (os_ptr_t) lock);
+}
+
+/*! \brief Creates an event which locks a reader-writer lock for writing. The
+ * lock must have been previously created before using this function.
+ * \ingroup group_os_public_api
+ * \param event The un-initialized event structure
+ * \param lock The lock which will be linked to this event
+ * \pre \ref CONFIG_OS_USE_EVENTS must be set
+ */
+static inline void os_rwlock_create_write_event(struct os_event *event,
+		struct os_rwlock *lock) {
+	const struct os_event_descriptor rwlock_event_descriptor = {
+		.is_triggered = __os_event_rwlock_write_is_triggered
+	};
+	__os_event_create(event, &rwlock_event_descriptor, (os_ptr_t) lock);
+}
+
+/*! \brief Get a reader-writer lock out of a \ref os_event structure.
+ * \ingroup group_os_public_api
+ * \param event The lock event
+ * \return The \ref os_rwlock structure
+ * \pre The event must have been generate from
+ * \ref os_rwlock_create_read_event or \ref os_rwlock_create_write_event
+ */
+static inline struct os_rwlock *os_event_get_rwlock(struct os_event *event) {
+	return (struct os_rwlock *) event->args;
+}
+
+/*! \brief Lock for reading, if it can be done without waiting
+ * \ingroup group_os_public_api
+ * \param lock The lock
+ * \return true if the lock is taken, false otherwise.
+ */
+bool os_rwlock_try_read_lock(struct os_rwlock *lock);
+
+/*! \brief Lock for reading. Wait while a writer holds the lock.
+ * \ingroup group_os_public_api
+ * \param lock The lock
+ */
+void os_rwlock_read_lock(struct os_rwlock *lock);
+
+/*! \brief Release a lock taken for reading
+ * \ingroup group_os_public_api
+ * \param lock The lock
+ */
+void os_rwlock_read_unlock(struct os_rwlock *lock);
+
+/*! \brief Lock for writing, if it can be done without waiting
+ * \ingroup group_os_public_api
+ * \param lock The lock
+ * \return true if the lock is taken, false otherwise.
+ */
+bool os_rwlock_try_write_lock(struct os_rwlock *lock);
+
+/*! \brief Lock for writing. Wait until no process reads or writes.
+ * \ingroup group_os_public_api
+ * \param lock The lock
+ */
+void os_rwlock_write_lock(struct os_rwlock *lock);
+
+/*! \brief Release a lock taken for writing. Only the process which has
+ * locked it can release it.
+ * \ingroup group_os_public_api
+ * \param lock The lock
+ */
+void os_rwlock_write_unlock(struct os_rwlock *lock);
+
+/*!
+ * \}
+ */
+
+#endif // __OS_RWLOCK_H__
@@ -0,0 +1,250 @@
+/*! \file
+ * \brief eeOS Schedulability Analysis
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+#if CONFIG_OS_USE_SCHEDULABILITY == true
+
+/*! \brief Sum of the weights of all the accounted tasks
+ */
+static uint32_t __os_schedulability_total_weight = 0;
+/*! \brief Minimal capacity of the analysed tasks. The task set is schedulable
+ * as long as the total weight does not exceed this value.
+ */
+static uint32_t __os_schedulability_min_capacity = UINT32_MAX;
+/*! \brief List of the analysed tasks (tasks with timing parameters)
+ */
+static struct os_task *__os_schedulability_list = NULL;
+
+/*! \brief Compute the weight of a task, which is proportional to the CPU share
+ * the scheduler gives to this task.
+ * \param task The task
+ * \return The weight of the task
+ */
+static inline uint32_t __os_schedulability_weight(struct os_task *task)
+{
+#if CONFIG_OS_USE_PRIORITY == true
+	return OS_SCHEDULABILITY_WEIGHT_SCALE /
+			((uint32_t) __os_task_get_process(task)->priority + 1);
+#else
+	return OS_SCHEDULABILITY_WEIGHT_SCALE;
+#endif
+}
+
+/*! \brief Compute the maximal total weight a task can afford while meeting its
+ * deadline: floor(deadline * weight / (WCET + 1))
+ * \param timing The timing parameters of the task, with an up-to-date weight
+ * \return The capacity of the task
+ */
+static inline uint32_t __os_schedulability_capacity(
+		struct os_task_timing *timing)
+{
+	uint64_t capacity = ((uint64_t) timing->deadline * timing->weight) /
+			((uint64_t) timing->wcet + 1);
+	return (capacity > UINT32_MAX) ? UINT32_MAX : (uint32_t) capacity;
+}
+
+/*! \brief Re-compute the minimal capacity from the list of analysed tasks
+ */
+static void __os_schedulability_update_min_capacity(void)
+{
+	struct os_task *task = __os_schedulability_list;
+
+	__os_schedulability_min_capacity = UINT32_MAX;
+	while (task) {
+		if (task->timing.capacity < __os_schedulability_min_capacity) {
+			__os_schedulability_min_capacity = task->timing.capacity;
+		}
+		task = task->timing.next;
+	}
+}
+
+/*! \brief Check if the task set is currently schedulable
+ * \return true if schedulable, false otherwise
+ */
+static inline bool __os_schedulability_check(void)
+{
+	return (__os_schedulability_total_weight <=
+			__os_schedulability_min_capacity);
+}
+
+bool __os_schedulability_task_add(struct os_task *task, bool use_timing)
+{
+	struct os_task_timing *timing = &task->timing;
+	bool is_critical, is_feasible;
+
+	if (use_timing) {
+		/* An implicit deadline is equal to the period */
+		if (!timing->deadline) {
+			timing->deadline = timing->period;
+		}
+		/* Only constrained deadlines are supported, and the WCET must
+		 * fit within the deadline.
+		 */
+		if (!timing->wcet || timing->wcet > timing->deadline
+				|| timing->deadline > timing->period) {
+			return false;
+		}
+	}
+	else {
+		/* The task is only accounted for its CPU share */
+		timing->wcet = 0;
+	}
+
+	/* Check if the current process is running inside a critical region. */
+	is_critical = os_is_critical();
+	/* The following code is critical, so enter in the critial region if
+	 * not already done.
+	 */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Account the CPU share of this task */
+	timing->weight = __os_schedulability_weight(task);
+	__os_schedulability_total_weight += timing->weight;
+	/* Insert the task in the list of analysed tasks */
+	if (timing->wcet) {
+		timing->capacity = __os_schedulability_capacity(timing);
+		if (timing->capacity < __os_schedulability_min_capacity) {
+			__os_schedulability_min_capacity = timing->capacity;
+		}
+		timing->next = __os_schedulability_list;
+		__os_schedulability_list = task;
+	}
+	/* Run the analysis on the new task set */
+	is_feasible = __os_schedulability_check();
+#if CONFIG_OS_SCHEDULABILITY_REJECT == true
+	if (!is_feasible) {
+		__os_schedulability_task_remove(task);
+	}
+#endif
+	/* Leave the critical region if the process was not previously in. */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	if (!is_feasible) {
+		HOOK_OS_SCHEDULABILITY_FAILED(task);
+	}
+
+#if CONFIG_OS_SCHEDULABILITY_REJECT == true
+	return is_feasible;
+#else
+	return true;
+#endif
+}
+
+void __os_schedulability_task_remove(struct os_task *task)
+{
+	struct os_task_timing *timing = &task->timing;
+	struct os_task **prev;
+	bool is_critical = os_is_critical();
+
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Make sure the task is accounted */
+	if (timing->weight) {
+		__os_schedulability_total_weight -= timing->weight;
+		timing->weight = 0;
+		/* Remove the task from the list of analysed tasks */
+		if (timing->wcet) {
+			prev = &__os_schedulability_list;
+			while (*prev && *prev != task) {
+				prev = &(*prev)->timing.next;
+			}
+			if (*prev) {
+				*prev = timing->next;
+			}
+			/* Only the most constraining task has an impact on the
+			 * minimal capacity.
+			 */
+			if (timing->capacity == __os_schedulability_min_capacity) {
+				__os_schedulability_update_min_capacity();
+			}
+		}
+	}
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+#if CONFIG_OS_USE_PRIORITY == true
+void __os_schedulability_task_set_priority(struct os_task *task,
+		enum os_priority priority)
+{
+	struct os_task_timing *timing = &task->timing;
+	uint32_t previous_capacity;
+	bool is_feasible = true;
+	bool is_critical = os_is_critical();
+
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Change the priority of the process */
+	__os_process_set_priority(__os_task_get_process(task), priority);
+	/* Update the analysis if the task is accounted */
+	if (timing->weight) {
+		__os_schedulability_total_weight -= timing->weight;
+		timing->weight = __os_schedulability_weight(task);
+		__os_schedulability_total_weight += timing->weight;
+		/* Only the capacity of this task changes */
+		if (timing->wcet) {
+			previous_capacity = timing->capacity;
+			timing->capacity = __os_schedulability_capacity(timing);
+			if (timing->capacity < __os_schedulability_min_capacity) {
+				__os_schedulability_min_capacity = timing->capacity;
+			}
+			else if (previous_capacity == __os_schedulability_min_capacity) {
+				__os_schedulability_update_min_capacity();
+			}
+		}
+		is_feasible = __os_schedulability_check();
+	}
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	/* A priority change is never rejected, only flagged */
+	if (!is_feasible) {
+		HOOK_OS_SCHEDULABILITY_FAILED(task);
+	}
+}
+#endif
+
+bool os_schedulability_is_feasible(void)
+{
+	return __os_schedulability_check();
+}
+
+os_tick_t os_task_get_response_time(struct os_task *task)
+{
+	struct os_task_timing *timing = &task->timing;
+	uint64_t response_time;
+
+	if (!timing->weight || !timing->wcet) {
+		return 0;
+	}
+	/* R = ceil((WCET + 1) * W / w) */
+	response_time = ((uint64_t) timing->wcet + 1)
+			* __os_schedulability_total_weight;
+	response_time = (response_time + timing->weight - 1) / timing->weight;
+	/* Saturate the value if it does not fit into a tick counter */
+	if (response_time > (os_tick_t) -1) {
+		return (os_tick_t) -1;
+	}
+	return (os_tick_t) response_time;
+}
+
+#endif
@@ -0,0 +1,193 @@
+/*! \file
+ * \brief eeOS Schedulability Analysis
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_SCHEDULABILITY_H__
+#define __OS_SCHEDULABILITY_H__
+
+/*! \addtogroup group_os
+ * \section section_os_schedulability Schedulability Analysis
+ *
+ * Optional timing parameters (\ref os_task_timing) can be given to a task:
+ * its period, its worst case execution time (WCET) and its relative deadline,
+ * all expressed in ticks. The task must be created with the
+ * \ref OS_TASK_USE_TIMING option:
+ * \code
+ * struct os_task my_task;
+ * my_task.timing.period = OS_MS_TO_TICKS(10);
+ * my_task.timing.wcet = OS_MS_TO_TICKS(2);
+ * my_task.timing.deadline = OS_MS_TO_TICKS(10);
+ * os_task_create(&my_task, my_func, NULL, 1024, OS_TASK_USE_TIMING);
+ * \endcode
+ *
+ * The scheduler of this kernel is a weighted round-robin: a process of
+ * priority \e p runs once every \e p + 1 visits of the scheduler. A task of
+ * priority \e p therefore gets a CPU share proportional to its weight
+ * \e w = 1 / (\e p + 1). Considering the worst case where every task is
+ * always ready, the response time of a task is bounded by:
+ * \code R = ceil((WCET + 1) * W / w) \endcode
+ * where \e W is the sum of the weights of all the tasks. The extra tick covers
+ * a release in the middle of a tick. The task set is schedulable if
+ * R <= deadline for every task with timing parameters. This translates into
+ * a maximal total weight for each task, the analysis then only keeps the
+ * minimum of these capacities, which makes it incremental: creating a task
+ * or changing its priority only updates the total weight and the capacity of
+ * this task. The list of analysed tasks is walked only when an analysed task
+ * is deleted, or when the priority of the most constraining task is lowered.
+ *
+ * Tasks without timing parameters are also accounted for, as they consume a
+ * share of the CPU. The application process and the event process are not,
+ * as they are only scheduled when no task is active or when an event is
+ * pending.
+ *
+ * When a task is created and breaks the analysis, it is rejected
+ * (\ref os_task_create returns false) if \ref CONFIG_OS_SCHEDULABILITY_REJECT
+ * is set, otherwise it is only flagged. In both cases
+ * \ref HOOK_OS_SCHEDULABILITY_FAILED is called. A priority change is never
+ * rejected, it is only flagged.
+ */
+
+/* Configuration options ******************************************************/
+
+/*! \def CONFIG_OS_USE_SCHEDULABILITY
+ * \brief Use this option to enable the schedulability analysis and the
+ * admission control of the tasks.
+ * \ingroup group_os_config
+ */
+#ifndef CONFIG_OS_USE_SCHEDULABILITY
+	#define CONFIG_OS_USE_SCHEDULABILITY false
+#endif
+
+/*! \def CONFIG_OS_SCHEDULABILITY_REJECT
+ * \brief If set to true, a task which makes the task set non-schedulable is
+ * rejected by \ref os_task_create. Otherwise it is accepted and the failure is
+ * only reported through \ref HOOK_OS_SCHEDULABILITY_FAILED and
+ * \ref os_schedulability_is_feasible.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_SCHEDULABILITY needs to be set
+ */
+#ifndef CONFIG_OS_SCHEDULABILITY_REJECT
+	#define CONFIG_OS_SCHEDULABILITY_REJECT true
+#endif
+
+/* Hooks **********************************************************************/
+
+/*! \def HOOK_OS_SCHEDULABILITY_FAILED
+ * \brief This hook is called when the task set becomes non-schedulable.
+ * \param task The task which has been created or which priority has been
+ * changed.
+ * \ingroup os_hook
+ * \pre \ref CONFIG_OS_USE_SCHEDULABILITY needs to be set
+ */
+#ifndef HOOK_OS_SCHEDULABILITY_FAILED
+	#define HOOK_OS_SCHEDULABILITY_FAILED(task)
+#endif
+
+/* Macros *********************************************************************/
+
+/*! \brief Scale used to compute the weight of a task. It is the least common
+ * multiple of 1 to 16, so the weights of most of the priorities are exact.
+ */
+#define OS_SCHEDULABILITY_WEIGHT_SCALE 720720UL
+
+/* Types **********************************************************************/
+
+#if CONFIG_OS_USE_SCHEDULABILITY == true
+/*! \brief Timing parameters of a task
+ */
+struct os_task_timing {
+	/*! \brief Period (or minimal inter-arrival time) of the task in ticks
+	 */
+	os_tick_t period;
+	/*! \brief Worst case execution time of the task in ticks
+	 */
+	os_tick_t wcet;
+	/*! \brief Relative deadline of the task in ticks. If 0, the deadline is
+	 * equal to the period.
+	 */
+	os_tick_t deadline;
+	/*! \brief Weight of the task accounted in the analysis, 0 if the task
+	 * is not accounted. Filled by the kernel.
+	 */
+	uint32_t weight;
+	/*! \brief Maximal total weight this task can afford while meeting its
+	 * deadline. Filled by the kernel.
+	 */
+	uint32_t capacity;
+	/*! \brief Next task in the list of analysed tasks. Filled by the
+	 * kernel.
+	 */
+	struct os_task *next;
+};
+#endif
+
+/* Internal API ***************************************************************/
+
+#if CONFIG_OS_USE_SCHEDULABILITY == true
+/*! \brief Account a task in the analysis and check the schedulability of the
+ * new task set.
+ * \ingroup group_os_internal_api
+ * \param task The task to be added
+ * \param use_timing true if the timing parameters of the task are valid
+ * \return false if the task has been rejected, true otherwise
+ */
+bool __os_schedulability_task_add(struct os_task *task, bool use_timing);
+/*! \brief Remove a task from the analysis
+ * \ingroup group_os_internal_api
+ * \param task The task to be removed
+ */
+void __os_schedulability_task_remove(struct os_task *task);
+#if CONFIG_OS_USE_PRIORITY == true
+/*! \brief Change the priority of a task and update the analysis
+ * \ingroup group_os_internal_api
+ * \param task The task
+ * \param priority The new priority
+ */
+void __os_schedulability_task_set_priority(struct os_task *task,
+		enum os_priority priority);
+#endif
+#endif
+
+/* Public API *****************************************************************/
+
+#if CONFIG_OS_USE_SCHEDULABILITY == true
+/*! \name Schedulability Analysis
+ *
+ * Set of functions to get the result of the schedulability analysis
+ *
+ * \{
+ */
+
+/*! \brief Check if the current task set is schedulable
+ * \ingroup group_os_public_api
+ * \return true if every task with timing parameters meets its deadline,
+ * false otherwise
+ * \pre \ref CONFIG_OS_USE_SCHEDULABILITY needs to be set
+ */
+bool os_schedulability_is_feasible(void);
+
+/*! \brief Get the worst case response time of a task
+ * \ingroup group_os_public_api
+ * \param task The task
+ * \return The worst case response time in ticks of the task, computed with
+ * the current task set. 0 if the task has no timing parameters.
+ * \pre \ref CONFIG_OS_USE_SCHEDULABILITY needs to be set
+ */
+os_tick_t os_task_get_response_time(struct os_task *task);
+
+/*!
+ * \}
+ */
+#endif
+
+#endif // __OS_SCHEDULABILITY_H__
@@ -14,6 +14,22 @@
 
 #include "os_core.h"
 
+/*! \brief Store the number of free units of a semaphore. If
+ * \ref CONFIG_OS_USE_ATOMIC is set, the waiting flag is updated as well.
+ * \param sem The semaphore
+ * \param units The number of free units
+ * \warning This function must be called inside a critical section.
+ */
+static inline void __os_semaphore_set_units(struct os_semaphore *sem,
+		os_semaphore_counter_t units) {
+#if CONFIG_OS_USE_ATOMIC == true
+	sem->counter = (os_wait_queue_is_empty(&sem->queue)) ? units
+			: (units | __OS_SEMAPHORE_WAITERS);
+#else
+	sem->counter = units;
+#endif
+}
+
 enum os_event_status __os_event_sempahore_is_triggered(struct os_process *proc,
 		os_ptr_t args)
 {
@@ -28,8 +44,12 @@ enum os_event_status __os_event_sempahore_is_triggered(struct os_process *proc,
 	if (!is_critical) {
 		os_enter_critical();
 	}
+	/* The processes of the waiting list are served first */
+	if (!os_wait_queue_is_empty(&sem->queue)) {
+		status = OS_EVENT_NONE;
+	}
 	/* If there is only 1 semaphore left */
-	if (sem->counter == 1) {
+	else if (sem->counter == 1) {
 		/* Take it */
 		sem->counter = 0;
 		/* It is the last semaphore so no further check is necessary */
@@ -52,31 +72,50 @@ enum os_event_status __os_event_sempahore_is_triggered(struct os_process *proc,
 	return status;
 }
 
-void os_semaphore_take(struct os_semaphore *sem)
+void os_semaphore_take_n(struct os_semaphore *sem, os_semaphore_counter_t n)
 {
+	os_semaphore_counter_t units;
 	/* Save the critical region status */
-	bool is_critical = os_is_critical();
+	bool is_critical;
 
+#if CONFIG_OS_USE_ATOMIC == true
+	/* Take the units without masking the interrupts if they are available
+	 * and no process is waiting. The counter is negative otherwise.
+	 */
+	while ((units = sem->counter) >= n) {
+		if (os_atomic_cas((volatile os_reg_t *) &sem->counter,
+				(os_reg_t) units, (os_reg_t) (units - n))) {
+			return;
+		}
+	}
+#endif
+	is_critical = os_is_critical();
 	/* Enter in a critical region if not already in */
 	if (!is_critical) {
 		os_enter_critical();
 	}
-	/* If all the semaphores are not taken, take one */
-	if (sem->counter > 0) {
-		/* Decrease the semaphore counter */
-		sem->counter--;
+	units = __os_semaphore_get_units(sem);
+	/* If enough units are free and nobody is waiting before, take them */
+	if (os_wait_queue_is_empty(&sem->queue) && units >= n) {
+		__os_semaphore_set_units(sem, units - n);
 	}
-	/* If the all the semaphores are taken, suspend this task */
+	/* Else suspend this task. The units are given to the waiters in the
+	 * order of the waiting list, a request is never overtaken by a smaller
+	 * one.
+	 */
 	else {
 		/* Queue element used to hold the process in the waiting list */
-		struct os_queue_process queue_elt;
+		struct os_semaphore_waiter waiter;
 		/* Disable this process */
 		__os_process_disable_naked(__os_process_get_current());
-		/* Assign the data associated to this queue entry */
-		queue_elt.proc = __os_process_get_current();
-		/* Add this process to the event list of the sempahore */
-		os_queue_process_add(&sem->queue, &queue_elt);
-		/* Manually switch the process context */
+		/* Add this process to the waiting list of the sempahore */
+		waiter.n = n;
+		os_wait_queue_add(&sem->queue, &waiter.elt,
+				__os_process_get_current());
+		__os_semaphore_set_units(sem, units);
+		/* Manually switch the process context. The units are taken when
+		 * the process resumes.
+		 */
 		os_switch_context(false);
 	}
 	/* Leave the critical region unless the CPU was previously in */
@@ -85,33 +124,49 @@ void os_semaphore_take(struct os_semaphore *sem)
 	}
 }
 
-void os_semaphore_release(struct os_semaphore *sem)
+void os_semaphore_release_n(struct os_semaphore *sem,
+		os_semaphore_counter_t n)
 {
+	os_semaphore_counter_t units;
+	struct os_wait_queue_elt *elt;
+	struct os_semaphore_waiter *waiter;
 	/* Save the critical region status */
-	bool is_critical = os_is_critical();
+	bool is_critical;
 
+#if CONFIG_OS_USE_ATOMIC == true
+	/* Release the units without masking the interrupts if no process is
+	 * waiting for them
+	 */
+	while ((units = sem->counter) >= 0 && sem->max - units >= n) {
+		if (os_atomic_cas((volatile os_reg_t *) &sem->counter,
+				(os_reg_t) units, (os_reg_t) (units + n))) {
+			return;
+		}
+	}
+#endif
+	is_critical = os_is_critical();
 	/* Enter in a critical region if not already in */
 	if (!is_critical) {
 		os_enter_critical();
 	}
-	/* Check if there is another process in the waiting list */
-	if (sem->queue) {
-		struct os_process *proc;
-		/* Pop the next process in the waiting list */
-		proc = os_queue_process_pop(&sem->queue)->proc;
-		/* Enable this process */
-		__os_process_enable_naked(proc);
-	}
-	/* Else check if the sempahore counter is not above the limit */
-	else if (sem->counter < sem->max) {
-		/* Increase the semaphore counter, in other word, release the
-		 * semaphore previously taken.
-		 */
-		sem->counter++;
+	/* Release the units, without going above the limit */
+	units = __os_semaphore_get_units(sem);
+	units = (sem->max - units <= n) ? sem->max : units + n;
+	/* Serve the waiters in order, as long as the first one can be
+	 * satisfied. Only the processes which get their units are waken up.
+	 */
+	while ((elt = os_wait_queue_head(&sem->queue)) != NULL) {
+		waiter = OS_CONTAINER_OF(elt, struct os_semaphore_waiter, elt);
+		if (units < waiter->n) {
+			break;
+		}
+		units -= waiter->n;
+		os_wait_queue_remove(&sem->queue, elt);
+		__os_process_enable_naked(elt->proc);
 	}
+	__os_semaphore_set_units(sem, units);
 	/* Leave the critical region unless the CPU was previously in */
 	if (!is_critical) {
 		os_leave_critical();
 	}
 }
-
@@ -15,6 +15,21 @@
 #ifndef __OS_SEMAPHORE_H__
 #define __OS_SEMAPHORE_H__
 
+/*! \addtogroup group_os
+ * \section section_os_semaphore Semaphores
+ *
+ * A semaphore (\ref os_semaphore) counts the free units of a resource.
+ * Several units can be taken (\ref os_semaphore_take_n) or released
+ * (\ref os_semaphore_release_n) at once, to manage a pool of buffers for
+ * example.
+ *
+ * The waiting processes are served strictly in the order of the waiting list
+ * (by priority, then in arrival order): a process never gets units while
+ * another one waits before it, even if it asks for less. A large request
+ * therefore cannot be starved by smaller ones. A release wakes up only the
+ * processes it can satisfy, each of them resumes with its units.
+ */
+
 /* Configuration options ******************************************************/
 
 /*! \def CONFIG_OS_SEMAPHORE_USE_8BIT_COUNTER
@@ -22,35 +37,77 @@
  * other words, if this option is set to true, the user can use up to 255
  * semaphores. If set to false, a 16-bit variable will be used instead alowing
  * up to 65,535 sempahores.
+ * \note This option is ignored if \ref CONFIG_OS_USE_ATOMIC or
+ * \ref CONFIG_OS_SEMAPHORE_USE_32BIT_COUNTER is set.
  * \ingroup group_os_config
  */
 #ifndef CONFIG_OS_SEMAPHORE_USE_8BIT_COUNTER
 	#define CONFIG_OS_SEMAPHORE_USE_8BIT_COUNTER true
 #endif
 
+/*! \def CONFIG_OS_SEMAPHORE_USE_32BIT_COUNTER
+ * \brief Use a 32-bit variable to count the number of sempahore available.
+ * \note This option is ignored if \ref CONFIG_OS_USE_ATOMIC is set, the
+ * counter is then a signed word, allowing up to 2^31 - 1 semaphores.
+ * \ingroup group_os_config
+ */
+#ifndef CONFIG_OS_SEMAPHORE_USE_32BIT_COUNTER
+	#define CONFIG_OS_SEMAPHORE_USE_32BIT_COUNTER false
+#endif
+
+/* Macros *********************************************************************/
+
+#if CONFIG_OS_USE_ATOMIC == true
+/*! \brief Flag of \ref os_semaphore::counter set while processes are in the
+ * waiting list. It makes the counter negative, so that the units are not
+ * taken or released by the fast paths.
+ */
+#define __OS_SEMAPHORE_WAITERS ((os_semaphore_counter_t) 0x80000000)
+#endif
+
 /* Types **********************************************************************/
 
 /*! \brief Type of the sempahore counter. Its size can vary from 8-bits to
- * 16-bits using the option \ref CONFIG_OS_SEMAPHORE_USE_8BIT_COUNTER.
+ * 32-bits using the options \ref CONFIG_OS_SEMAPHORE_USE_8BIT_COUNTER and
+ * \ref CONFIG_OS_SEMAPHORE_USE_32BIT_COUNTER. If \ref CONFIG_OS_USE_ATOMIC is
+ * set, it is a signed word.
  */
-#if CONFIG_OS_SEMAPHORE_USE_8BIT_COUNTER == true
+#if CONFIG_OS_USE_ATOMIC == true
+typedef int32_t os_semaphore_counter_t;
+#elif CONFIG_OS_SEMAPHORE_USE_32BIT_COUNTER == true
+typedef uint32_t os_semaphore_counter_t;
+#elif CONFIG_OS_SEMAPHORE_USE_8BIT_COUNTER == true
 typedef uint8_t os_semaphore_counter_t;
 #else
 typedef uint16_t os_semaphore_counter_t;
 #endif
 
+/*! \brief Waiter record of a semaphore. It is allocated on the stack of the
+ * waiting process.
+ */
+struct os_semaphore_waiter {
+	/*! \brief Element of the waiting list
+	 */
+	struct os_wait_queue_elt elt;
+	/*! \brief Number of units requested
+	 */
+	os_semaphore_counter_t n;
+};
+
 /*! \brief Semaphore Structure
  */
 struct os_semaphore {
-	/*! \brief Counter to hold the current number of free semaphores
+	/*! \brief Counter to hold the current number of free semaphores. If
+	 * \ref CONFIG_OS_USE_ATOMIC is set, it is combined with
+	 * \ref __OS_SEMAPHORE_WAITERS.
 	 */
-	os_semaphore_counter_t counter;
+	volatile os_semaphore_counter_t counter;
 	/*! \brief Maximum semaphore available
 	 */
 	os_semaphore_counter_t max;
 	/*! \brief Next processes on the waiting list
 	 */
-	struct os_queue_process *queue;
+	struct os_wait_queue queue;
 };
 
 /* Internal API ***************************************************************/
@@ -64,6 +121,20 @@ struct os_semaphore {
 enum os_event_status __os_event_sempahore_is_triggered(struct os_process *proc,
 		os_ptr_t args);
 
+/*! \brief Get the number of free units of a semaphore
+ * \ingroup group_os_internal_api
+ * \param sem The semaphore
+ * \return The number of free units
+ */
+static inline os_semaphore_counter_t __os_semaphore_get_units(
+		struct os_semaphore *sem) {
+#if CONFIG_OS_USE_ATOMIC == true
+	return sem->counter & ~__OS_SEMAPHORE_WAITERS;
+#else
+	return sem->counter;
+#endif
+}
+
 /* Public API *****************************************************************/
 
 /*! \name Semaphores
@@ -85,7 +156,7 @@ static inline void os_semaphore_create(struct os_semaphore *sem,
 		os_semaphore_counter_t initial_count) {
 	sem->counter = initial_count;
 	sem->max = counter;
-	sem->queue = NULL;
+	os_wait_queue_init(&sem->queue);
 }
 
 /*! \brief Creates a binary semaphore
@@ -122,20 +193,45 @@ static inline struct os_semaphore *os_event_get_semaphore(struct os_event *event
 	return (struct os_semaphore *) event->args;
 }
 
+/*! \brief Take several units of a semaphore at once. If not enough units are
+ * available, or if other processes are waiting before this one, wait until
+ * they can all be taken.
+ * \ingroup group_os_public_api
+ * \param sem The semaphore to take
+ * \param n The number of units, it must not be greater than the maximum count
+ * of the semaphore
+ * \pre The semaphore must have previously been created
+ */
+void os_semaphore_take_n(struct os_semaphore *sem, os_semaphore_counter_t n);
+
 /*! \brief Take a semaphore. If no semaphore is available, wait until it gets
  * free
  * \ingroup group_os_public_api
  * \param sem The semaphore to take
  * \pre The semaphore must have previously been created
  */
-void os_semaphore_take(struct os_semaphore *sem);
+static inline void os_semaphore_take(struct os_semaphore *sem) {
+	os_semaphore_take_n(sem, 1);
+}
+
+/*! \brief Releases several units of a semaphore at once. The waiting
+ * processes which can be satisfied are waken up, in order.
+ * \ingroup group_os_public_api
+ * \param sem The semaphore to release
+ * \param n The number of units
+ * \pre The semaphore must have previously been created
+ */
+void os_semaphore_release_n(struct os_semaphore *sem,
+		os_semaphore_counter_t n);
 
 /*! \brief Releases a semaphore.
  * \ingroup group_os_public_api
  * \param sem The semaphore to release
  * \pre The semaphore must have previously been created
  */
-void os_semaphore_release(struct os_semaphore *sem);
+static inline void os_semaphore_release(struct os_semaphore *sem) {
+	os_semaphore_release_n(sem, 1);
+}
 
 /*!
  * \}
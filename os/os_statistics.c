@@ -113,8 +113,91 @@ os_cy_t os_statistics_get_task_switch_time(void)
 	return (task_switch_max_cy + task_switch_min_cy) / 2;
 }
 
+uint32_t os_statistics_get_task_voluntary_switch(struct os_task *task)
+{
+	return __os_task_get_process(task)->voluntary_switch_counter;
+}
+
+uint32_t os_statistics_get_task_involuntary_switch(struct os_task *task)
+{
+	return __os_task_get_process(task)->involuntary_switch_counter;
+}
+
 #endif // CONFIG_OS_STATISTICS_MONITOR_TASK_SWITCH == true
 
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE == true
+void __os_statistics_task_release(struct os_task *task, os_tick_t release)
+{
+	extern volatile os_tick_t os_tick_counter;
+	struct os_task_release *stats = &task->release;
+	os_tick_t late_ticks;
+	os_cy_t timer, top;
+	uint32_t lateness;
+	int bucket;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Read the tick counter and the tick timer consistently */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	timer = os_read_tick_timer();
+	late_ticks = os_tick_counter - release;
+	top = os_get_tick_timer_top() / __os_tick_get_step();
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	/* Lateness since the release tick, saturated */
+	if (!top || late_ticks >= (UINT32_MAX - timer) / top) {
+		lateness = UINT32_MAX;
+	}
+	else {
+		lateness = (uint32_t) late_ticks * top + timer;
+	}
+
+	/* Update the statistics */
+	stats->count++;
+	if (lateness < stats->lateness_min) {
+		stats->lateness_min = lateness;
+	}
+	if (lateness > stats->lateness_max) {
+		stats->lateness_max = lateness;
+	}
+	/* The histogram uses a logarithmic scale */
+	bucket = (lateness) ? 32 - clz(lateness) : 0;
+	if (bucket >= CONFIG_OS_STATISTICS_RELEASE_HISTOGRAM_SIZE) {
+		bucket = CONFIG_OS_STATISTICS_RELEASE_HISTOGRAM_SIZE - 1;
+	}
+	if (stats->histogram[bucket] != 0xFFFF) {
+		stats->histogram[bucket]++;
+	}
+}
+
+void os_statistics_reset_task_release(struct os_task *task)
+{
+	struct os_task_release *stats = &task->release;
+	int i;
+
+	stats->count = 0;
+	stats->lateness_min = UINT32_MAX;
+	stats->lateness_max = 0;
+	for (i = 0; i < CONFIG_OS_STATISTICS_RELEASE_HISTOGRAM_SIZE; i++) {
+		stats->histogram[i] = 0;
+	}
+}
+
+uint32_t os_statistics_get_task_release_jitter(struct os_task *task)
+{
+	/* No release yet */
+	if (!task->release.count) {
+		return 0;
+	}
+	return task->release.lateness_max - task->release.lateness_min;
+}
+#endif
+
 uint8_t os_statistics_task_cpu_allocation(struct os_task *task)
 {
 	struct os_process *proc = __os_task_get_process(task);
@@ -22,6 +22,8 @@
  * This enables the following functions:
  * - \ref os_statistics_get_task_switch_time
  * - \ref os_statistics_get_task_switch_time_jitter
+ * - \ref os_statistics_get_task_voluntary_switch
+ * - \ref os_statistics_get_task_involuntary_switch
  * \ingroup group_os_config
  */
 #ifndef CONFIG_OS_STATISTICS_MONITOR_TASK_SWITCH
@@ -94,6 +96,15 @@
 	void __os_statistics_switch_context_stop(os_cy_t offset_cy);
 #endif
 
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE == true
+	/*! \brief Update the release statistics of a task
+	 * \param task The task which has just been released
+	 * \param release The release time in ticks
+	 */
+	void __os_statistics_task_release(struct os_task *task,
+			os_tick_t release);
+#endif
+
 /* Public API *****************************************************************/
 
 /*! \name Statistics
@@ -120,6 +131,26 @@ os_cy_t os_statistics_get_task_switch_time(void);
  */
 os_cy_t os_statistics_get_task_switch_time_jitter(void);
 
+/*!
+ * \brief Get the number of times a task released the CPU by itself
+ * (\ref os_yield, sleep, blocking call...)
+ * \ingroup group_os_public_api
+ * \param task The task to evaluate
+ * \return The number of voluntary context switches of this task
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_TASK_SWITCH must be set
+ */
+uint32_t os_statistics_get_task_voluntary_switch(struct os_task *task);
+
+/*!
+ * \brief Get the number of times a task has been preempted by the tick
+ * interrupt
+ * \ingroup group_os_public_api
+ * \param task The task to evaluate
+ * \return The number of involuntary context switches of this task
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_TASK_SWITCH must be set
+ */
+uint32_t os_statistics_get_task_involuntary_switch(struct os_task *task);
+
 /*!
  * \brief Theoretical estimation of the CPU load of a task.
  * It is based on the number of current active tasks in the list and their
@@ -132,6 +163,116 @@ os_cy_t os_statistics_get_task_switch_time_jitter(void);
  */
 uint8_t os_statistics_task_cpu_allocation(struct os_task *task);
 
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE == true
+/*!
+ * \brief Reset the release statistics of a task
+ * \ingroup group_os_public_api
+ * \param task The task
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE must be set
+ */
+void os_statistics_reset_task_release(struct os_task *task);
+
+/*!
+ * \brief Get the number of releases of a periodic task
+ * \ingroup group_os_public_api
+ * \param task The task to evaluate
+ * \return The number of calls of \ref os_task_delay_until
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE must be set
+ */
+static inline uint32_t os_statistics_get_task_release_count(
+		struct os_task *task) {
+	return task->release.count;
+}
+
+/*!
+ * \brief Get the minimal release lateness of a periodic task
+ * \ingroup group_os_public_api
+ * \param task The task to evaluate
+ * \return The minimal lateness in counts of the tick timer
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE must be set
+ */
+static inline uint32_t os_statistics_get_task_release_lateness_min(
+		struct os_task *task) {
+	return task->release.lateness_min;
+}
+
+/*!
+ * \brief Get the maximal release lateness of a periodic task
+ * \ingroup group_os_public_api
+ * \param task The task to evaluate
+ * \return The maximal lateness in counts of the tick timer
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE must be set
+ */
+static inline uint32_t os_statistics_get_task_release_lateness_max(
+		struct os_task *task) {
+	return task->release.lateness_max;
+}
+
+/*!
+ * \brief Get the release jitter of a periodic task, which is the difference
+ * between its maximal and its minimal lateness
+ * \ingroup group_os_public_api
+ * \param task The task to evaluate
+ * \return The release jitter in counts of the tick timer
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE must be set
+ */
+uint32_t os_statistics_get_task_release_jitter(struct os_task *task);
+
+/*!
+ * \brief Get the release lateness histogram of a periodic task. Entry \b i
+ * counts the releases which lateness is within [2^(i-1), 2^i[, entry 0 counts
+ * the releases on time. The counters saturate at 0xFFFF.
+ * \ingroup group_os_public_api
+ * \param task The task to evaluate
+ * \return The histogram, of \ref CONFIG_OS_STATISTICS_RELEASE_HISTOGRAM_SIZE
+ * entries
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE must be set
+ */
+static inline const uint16_t *os_statistics_get_task_release_histogram(
+		struct os_task *task) {
+	return task->release.histogram;
+}
+#endif
+
+#if CONFIG_OS_STATISTICS_MONITOR_BARRIER == true
+/*!
+ * \brief Get the number of phases completed by a barrier
+ * \ingroup group_os_public_api
+ * \param barrier The barrier to evaluate
+ * \return The number of times the whole group has reached the barrier
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_BARRIER must be set
+ */
+static inline uint32_t os_statistics_get_barrier_phases(
+		struct os_barrier *barrier) {
+	return barrier->phases;
+}
+
+/*!
+ * \brief Get the arrival skew of the last phase of a barrier
+ * \ingroup group_os_public_api
+ * \param barrier The barrier to evaluate
+ * \return The time between the first and the last arrival, in nanoseconds
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_BARRIER must be set
+ */
+static inline os_time_t os_statistics_get_barrier_skew_last(
+		struct os_barrier *barrier) {
+	return barrier->skew_last;
+}
+
+/*!
+ * \brief Get the maximal arrival skew of a barrier
+ * \ingroup group_os_public_api
+ * \param barrier The barrier to evaluate
+ * \return The maximal time between the first and the last arrival of a
+ * phase, in nanoseconds
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_BARRIER must be set
+ */
+static inline os_time_t os_statistics_get_barrier_skew_max(
+		struct os_barrier *barrier) {
+	return barrier->skew_max;
+}
+#endif
+
 /*!
  * \}
  */
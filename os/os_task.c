@@ -18,25 +18,82 @@
 void os_task_delay(os_tick_t tick_nb)
 {
 	extern volatile os_tick_t os_tick_counter;
-	os_tick_t start_tick, last_tick;
+	os_tick_t start_tick;
 
 	__HOOK_OS_DEBUG_TRACE_LOG(OS_DEBUG_TRACE_TASK_DELAY_START, tick_nb);
 
 	start_tick = os_tick_counter;
-	last_tick = os_tick_counter + tick_nb;
-	/* Check if the counter has been wrapped */
-	if (last_tick < start_tick) {
-		/* Monitor the 1rst half */
-		while (os_tick_counter > start_tick) {
-			os_yield();
-		}
-	}
-	while (os_tick_counter < last_tick) {
+	/* Compare the elapsed time rather than the tick values, a tick
+	 * interrupt can advance the counter by several ticks and jump over
+	 * the end of the delay when the counter wraps.
+	 */
+	while ((os_tick_t) (os_tick_counter - start_tick) < tick_nb) {
 		os_yield();
 	}
 
 	__HOOK_OS_DEBUG_TRACE_LOG(OS_DEBUG_TRACE_TASK_DELAY_STOP, tick_nb);
 }
+
+void os_task_delay_until(os_tick_t *last_wake, os_tick_t period)
+{
+	extern volatile os_tick_t os_tick_counter;
+	os_tick_t release = *last_wake + period;
+
+	__HOOK_OS_DEBUG_TRACE_LOG(OS_DEBUG_TRACE_TASK_DELAY_UNTIL_START, period);
+
+	/* As long as the release time is not reached, the remaining time is
+	 * within [1, period]. Otherwise, it is either 0 or it wraps, which also
+	 * handles the tick counter overflow.
+	 */
+	while ((os_tick_t) (release - os_tick_counter - 1) < period) {
+		os_yield();
+	}
+	*last_wake = release;
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE == true
+	/* Measure the lateness of this release */
+	if (os_task_get_current()) {
+		__os_statistics_task_release(os_task_get_current(), release);
+	}
+#endif
+
+	__HOOK_OS_DEBUG_TRACE_LOG(OS_DEBUG_TRACE_TASK_DELAY_UNTIL_STOP, period);
+}
+#endif
+
+#if CONFIG_OS_USE_TIME == true
+void os_task_delay_us(uint32_t delay_us)
+{
+	const os_time_t spin = OS_TIME_US(CONFIG_OS_TASK_DELAY_SPIN_US);
+	os_time_t deadline = os_time_now() + OS_TIME_US(delay_us);
+	os_time_t remaining = OS_TIME_US(delay_us);
+	os_time_t now;
+#if CONFIG_OS_USE_TICK_COUNTER == true
+	os_time_t margin;
+
+	/* Wait for the whole ticks. A tick interrupt advances the tick counter
+	 * by the tick step, so os_task_delay can return up to (step - 1) ticks
+	 * later than requested. Keep this margin to never overshoot.
+	 */
+	margin = spin + (os_time_t) (__os_tick_get_step() - 1)
+			* OS_TIME_NS_PER_TICK;
+	if (remaining > margin + OS_TIME_NS_PER_TICK) {
+		os_task_delay((os_tick_t) ((remaining - margin)
+				/ OS_TIME_NS_PER_TICK));
+	}
+#endif
+	/* Release the CPU as long as the remaining time exceeds the spin
+	 * bound.
+	 */
+	while ((now = os_time_now()) < deadline) {
+		remaining = deadline - now;
+		if (remaining <= spin) {
+			break;
+		}
+		os_yield();
+	}
+	/* Spin for the rest */
+	while (os_time_now() < deadline);
+}
 #endif
 
 bool os_task_create(struct os_task *task, os_proc_ptr_t task_ptr, os_ptr_t args,
@@ -60,6 +117,23 @@ bool os_task_create(struct os_task *task, os_proc_ptr_t task_ptr, os_ptr_t args,
 #endif
 	/* Save the options */
 	task->options = options;
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE == true
+	/* Reset the release statistics */
+	os_statistics_reset_task_release(task);
+#endif
+#if CONFIG_OS_USE_SCHEDULABILITY == true
+	/* The task is not yet part of the schedulability analysis */
+	task->timing.weight = 0;
+#endif
+#if CONFIG_OS_USE_TASK_NOTIFY == true
+	/* No notification yet */
+	task->notify_value = 0;
+	task->notify_state = OS_TASK_NOTIFY_STATE_NONE;
+#endif
+	/* Set the preemption mode of the task */
+	if (options & OS_TASK_COOPERATIVE) {
+		os_task_set_cooperative(task, true);
+	}
 	/* Set the priority of the task */
 #if CONFIG_OS_USE_PRIORITY == true
 	os_task_set_priority(task, CONFIG_OS_TASK_DEFAULT_PRIORITY);
@@ -68,6 +142,16 @@ bool os_task_create(struct os_task *task, os_proc_ptr_t task_ptr, os_ptr_t args,
 	if (!os_process_context_load(&task->core, task_ptr, args)) {
 		return false;
 	}
+#if CONFIG_OS_USE_SCHEDULABILITY == true
+	/* Admission control */
+	if (!__os_schedulability_task_add(task,
+			(options & OS_TASK_USE_TIMING) != 0)) {
+		if (!(options & OS_TASK_USE_CUSTOM_STACK)) {
+			os_free(task->stack);
+		}
+		return false;
+	}
+#endif
 	/* Enable the task */
 	if (!(options & OS_TASK_DISABLE)) {
 		os_task_enable(task);
@@ -75,3 +159,124 @@ bool os_task_create(struct os_task *task, os_proc_ptr_t task_ptr, os_ptr_t args,
 
 	return true;
 }
+
+#if CONFIG_OS_USE_TASK_NOTIFY == true
+void os_task_notify(struct os_task *task, uint32_t value,
+		enum os_task_notify_action action)
+{
+	struct os_process *proc = __os_task_get_process(task);
+	uint8_t previous_state;
+	/* Save the critical region status */
+	bool is_critical = os_is_critical();
+
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Update the notification word */
+	switch (action) {
+	case OS_TASK_NOTIFY_GIVE:
+		task->notify_value++;
+		break;
+	case OS_TASK_NOTIFY_SET_BITS:
+		task->notify_value |= value;
+		break;
+	case OS_TASK_NOTIFY_OVERWRITE:
+		task->notify_value = value;
+		break;
+	}
+	previous_state = task->notify_state;
+	task->notify_state = OS_TASK_NOTIFY_STATE_PENDING;
+	/* Wake up the task if it waits for this notification, unless it has
+	 * already been enabled by other means.
+	 */
+	if (previous_state == OS_TASK_NOTIFY_STATE_WAITING
+			&& !__os_process_is_enabled(proc)) {
+		__os_process_enable_naked(proc);
+	}
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+/*! \brief Suspend the current task until it gets notified. It can be enabled
+ * by other means in the meantime, the caller must then check its condition
+ * again.
+ * \param task The current task
+ * \warning This function must be called inside a critical section.
+ */
+static void __os_task_notify_suspend(struct os_task *task)
+{
+	task->notify_state = OS_TASK_NOTIFY_STATE_WAITING;
+	__os_process_disable_naked(__os_task_get_process(task));
+	/* Manually switch the process context */
+	os_switch_context(false);
+}
+
+uint32_t os_task_notify_wait(uint32_t clear_on_exit)
+{
+	struct os_task *task = os_task_get_current();
+	uint32_t value;
+	bool is_critical;
+
+	/* Only a task can wait for a notification */
+	if (!task) {
+		return 0;
+	}
+	/* Save the critical region status */
+	is_critical = os_is_critical();
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Suspend the task until it gets notified */
+	while (task->notify_state != OS_TASK_NOTIFY_STATE_PENDING) {
+		__os_task_notify_suspend(task);
+	}
+	/* Consume the notification */
+	value = task->notify_value;
+	task->notify_value = value & ~clear_on_exit;
+	task->notify_state = OS_TASK_NOTIFY_STATE_NONE;
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return value;
+}
+
+uint32_t os_task_notify_take(bool clear_on_exit)
+{
+	struct os_task *task = os_task_get_current();
+	uint32_t value;
+	bool is_critical;
+
+	/* Only a task can wait for a notification */
+	if (!task) {
+		return 0;
+	}
+	/* Save the critical region status */
+	is_critical = os_is_critical();
+	/* Enter in a critical region if not already in */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Suspend the task until the count is not null */
+	while (!task->notify_value) {
+		__os_task_notify_suspend(task);
+	}
+	/* Take one unit, or all of them */
+	value = task->notify_value;
+	task->notify_value = (clear_on_exit) ? 0 : value - 1;
+	/* The remaining units stay pending for the next take */
+	task->notify_state = (task->notify_value) ? OS_TASK_NOTIFY_STATE_PENDING
+			: OS_TASK_NOTIFY_STATE_NONE;
+	/* Leave the critical region unless the CPU was previously in */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+
+	return value;
+}
+#endif
@@ -21,6 +21,21 @@
  * A task (\ref os_task) is a process which can be interrupted by the process
  * scheduler at any time. Therefore its execution time is not predictable
  * without a complete view of the active process list.
+ *
+ * A task created with the \ref OS_TASK_COOPERATIVE option is a cooperative
+ * task. It is never preempted by the tick interrupt and runs until it releases
+ * the CPU by itself (\ref os_yield, \ref os_task_delay, sleeping on an
+ * event, waiting for a semaphore...). Such tasks do not need to protect the
+ * state they share with other cooperative tasks, while latency-critical tasks
+ * can stay preemptive.
+ *
+ * Each task can own a notification word (\ref CONFIG_OS_USE_TASK_NOTIFY). A
+ * process or an interrupt notifies a task directly (\ref os_task_notify),
+ * which updates the word and wakes the task up if it waits for it
+ * (\ref os_task_notify_wait). It replaces a binary or a counting semaphore
+ * (\ref os_task_notify_give and \ref os_task_notify_take), or an event group,
+ * when there is a single receiver, without any waiting list nor event to go
+ * through.
  */
 
 /* Configuration options ******************************************************/
@@ -33,6 +48,53 @@
 	#define CONFIG_OS_TASK_DEFAULT_PRIORITY OS_PRIORITY_1
 #endif
 
+/*! \def CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE
+ * \brief Give statistics about the release lateness of the periodic tasks
+ * (\ref os_task_delay_until).
+ * This enables the following functions:
+ * - \ref os_statistics_get_task_release_count
+ * - \ref os_statistics_get_task_release_lateness_min
+ * - \ref os_statistics_get_task_release_lateness_max
+ * - \ref os_statistics_get_task_release_jitter
+ * - \ref os_statistics_get_task_release_histogram
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_TICK_COUNTER needs to be set
+ */
+#ifndef CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE
+	#define CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE false
+#endif
+
+/*! \def CONFIG_OS_STATISTICS_RELEASE_HISTOGRAM_SIZE
+ * \brief Number of entries of the release lateness histogram of a task. Entry
+ * \b i counts the releases which lateness needs \b i bits, the last entry
+ * counts all the larger ones.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE needs to be set
+ */
+#ifndef CONFIG_OS_STATISTICS_RELEASE_HISTOGRAM_SIZE
+	#define CONFIG_OS_STATISTICS_RELEASE_HISTOGRAM_SIZE 24
+#endif
+
+/*! \def CONFIG_OS_TASK_DELAY_SPIN_US
+ * \brief Maximal time in microseconds \ref os_task_delay_us spins on the time
+ * base at the end of a delay. Below this value, the task keeps the CPU to wake
+ * up accurately. Above it, the task releases the CPU to the other processes.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_TIME needs to be set
+ */
+#ifndef CONFIG_OS_TASK_DELAY_SPIN_US
+	#define CONFIG_OS_TASK_DELAY_SPIN_US 50
+#endif
+
+/*! \def CONFIG_OS_USE_TASK_NOTIFY
+ * \brief Use this option to give each task a notification word (see
+ * \ref os_task_notify).
+ * \ingroup group_os_config
+ */
+#ifndef CONFIG_OS_USE_TASK_NOTIFY
+	#define CONFIG_OS_USE_TASK_NOTIFY false
+#endif
+
 /* Macros *********************************************************************/
 
 /*! \brief Allocate memory for the stack
@@ -72,8 +134,71 @@ enum os_task_option {
 	 * \ref CONFIG_OS_USE_MALLOC is set.
 	 */
 	OS_TASK_USE_CUSTOM_STACK = 2,
+	/*! \brief The task is cooperative. It will never be preempted by the
+	 * tick interrupt, see \ref os_task_set_cooperative.
+	 */
+	OS_TASK_COOPERATIVE = 4,
+	/*! \brief The timing parameters (\ref os_task::timing) of the task are
+	 * set and the task is part of the schedulability analysis, see
+	 * \ref section_os_schedulability. This option is available only if
+	 * \ref CONFIG_OS_USE_SCHEDULABILITY is set.
+	 */
+	OS_TASK_USE_TIMING = 8,
+};
+
+#if CONFIG_OS_USE_TASK_NOTIFY == true
+/*! \brief How a notification updates the notification word of a task
+ */
+enum os_task_notify_action {
+	/*! \brief Increment the word, like a counting semaphore (see
+	 * \ref os_task_notify_take)
+	 */
+	OS_TASK_NOTIFY_GIVE = 0,
+	/*! \brief Set bits of the word, like an event group
+	 */
+	OS_TASK_NOTIFY_SET_BITS = 1,
+	/*! \brief Overwrite the word with a value, like a mailbox of depth 1
+	 */
+	OS_TASK_NOTIFY_OVERWRITE = 2,
 };
 
+/*! \brief State of the notification word of a task
+ */
+enum os_task_notify_state {
+	/*! \brief No notification is pending
+	 */
+	OS_TASK_NOTIFY_STATE_NONE = 0,
+	/*! \brief The task waits for a notification
+	 */
+	OS_TASK_NOTIFY_STATE_WAITING = 1,
+	/*! \brief A notification is pending
+	 */
+	OS_TASK_NOTIFY_STATE_PENDING = 2,
+};
+#endif
+
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE == true
+/*! \brief Release statistics of a periodic task. The lateness is the delay
+ * between the release time and the time the task actually resumes. It is
+ * measured in counts of the tick timer (\ref os_read_tick_timer), which are
+ * CPU cycles with the \ref CONFIG_OS_SCHEDULER_USE_COMPARE scheduler.
+ */
+struct os_task_release {
+	/*! \brief Number of releases
+	 */
+	uint32_t count;
+	/*! \brief Minimal lateness
+	 */
+	uint32_t lateness_min;
+	/*! \brief Maximal lateness
+	 */
+	uint32_t lateness_max;
+	/*! \brief Histogram of the lateness, on a logarithmic scale
+	 */
+	uint16_t histogram[CONFIG_OS_STATISTICS_RELEASE_HISTOGRAM_SIZE];
+};
+#endif
+
 /*! Structure holding the context of a task
  */
 struct os_task {
@@ -86,6 +211,24 @@ struct os_task {
 	/*! \brief Task options
 	 */
 	enum os_task_option options;
+#if CONFIG_OS_USE_SCHEDULABILITY == true
+	/*! \brief Timing parameters used by the schedulability analysis
+	 */
+	struct os_task_timing timing;
+#endif
+#if CONFIG_OS_STATISTICS_MONITOR_TASK_RELEASE == true
+	/*! \brief Release statistics
+	 */
+	struct os_task_release release;
+#endif
+#if CONFIG_OS_USE_TASK_NOTIFY == true
+	/*! \brief Notification word
+	 */
+	volatile uint32_t notify_value;
+	/*! \brief State of the notification word (\ref os_task_notify_state)
+	 */
+	volatile uint8_t notify_state;
+#endif
 };
 
 /* Internal API ***************************************************************/
@@ -142,6 +285,46 @@ bool os_task_create(struct os_task *task, os_proc_ptr_t task_ptr, os_ptr_t args,
  * tick interrupt is disabled.
  */
 void os_task_delay(os_tick_t tick_nb);
+
+/*! \brief Block the execution of a task until an absolute release time. This
+ * function is used to implement periodic tasks without drift, as the next
+ * release time does not depend on the execution time of the task:
+ * \code
+ * void my_task(os_ptr_t args)
+ * {
+ *	os_tick_t last_wake = os_get_tick_counter();
+ *	while (true) {
+ *		os_task_delay_until(&last_wake, OS_MS_TO_TICKS(10));
+ *		...
+ *	}
+ * }
+ * \endcode
+ * If the release time is already passed, the function returns immediately.
+ * \ingroup group_os_public_api
+ * \param last_wake The previous release time of the task. It is updated with
+ * the new release time: \b last_wake + \b period.
+ * \param period The period of the task in ticks
+ * \pre \ref CONFIG_OS_USE_TICK_COUNTER needs to be set first.
+ * \warning This functon needs the preemptive scheduler to run.
+ */
+void os_task_delay_until(os_tick_t *last_wake, os_tick_t period);
+#endif
+
+#if CONFIG_OS_USE_TIME == true
+/*! \brief Block the execution of a task for a number of microseconds, with a
+ * sub-tick precision.
+ * The whole ticks are waited with \ref os_task_delay, then the task releases
+ * the CPU until the remaining time is lower than
+ * \ref CONFIG_OS_TASK_DELAY_SPIN_US, and finally spins on the time base
+ * (\ref os_time_now) for the rest. The spin time is therefore bounded by
+ * \ref CONFIG_OS_TASK_DELAY_SPIN_US, plus the time the other processes keep
+ * the CPU after the last release.
+ * \ingroup group_os_public_api
+ * \param delay_us The delay in microseconds
+ * \pre \ref CONFIG_OS_USE_TIME needs to be set first.
+ * \warning This functon needs the preemptive scheduler to run.
+ */
+void os_task_delay_us(uint32_t delay_us);
 #endif
 
 #if CONFIG_OS_USE_PRIORITY == true
@@ -153,7 +336,11 @@ void os_task_delay(os_tick_t tick_nb);
 static inline void os_task_set_priority(struct os_task *task,
 		enum os_priority priority) {
 	__HOOK_OS_DEBUG_TRACE_LOG(OS_DEBUG_TRACE_TASK_SET_PRIORITY, priority);
+#if CONFIG_OS_USE_SCHEDULABILITY == true
+	__os_schedulability_task_set_priority(task, priority);
+#else
 	__os_process_set_priority(__os_task_get_process(task), priority);
+#endif
 }
 /*! \brief Get the priority of a task
  * \ingroup group_os_public_api
@@ -174,6 +361,9 @@ static inline enum os_priority os_task_get_priority(struct os_task *task) {
  */
 static inline void os_task_delete(struct os_task *task) {
 	__HOOK_OS_DEBUG_TRACE_LOG(OS_DEBUG_TRACE_TASK_DELETE, task);
+#if CONFIG_OS_USE_SCHEDULABILITY == true
+	__os_schedulability_task_remove(task);
+#endif
 	__os_process_disable(__os_task_get_process(task));
 	// Free the task stack if needed
 	if (!(task->options & OS_TASK_USE_CUSTOM_STACK)) {
@@ -199,6 +389,27 @@ static inline void os_task_disable(struct os_task *task) {
 	__os_process_disable(__os_task_get_process(task));
 }
 
+/*! \brief Change the preemption mode of a task
+ * \ingroup group_os_public_api
+ * \param task The task
+ * \param is_cooperative true to make the task cooperative, it will then never
+ * be preempted by the tick interrupt. false to make it preemptive.
+ */
+static inline void os_task_set_cooperative(struct os_task *task,
+		bool is_cooperative) {
+	__os_process_set_cooperative(__os_task_get_process(task),
+			is_cooperative);
+}
+
+/*! \brief Check if a task is cooperative
+ * \ingroup group_os_public_api
+ * \param task The task to be checked
+ * \return true if the task is cooperative, false if it is preemptive
+ */
+static inline bool os_task_is_cooperative(struct os_task *task) {
+	return __os_process_is_cooperative(__os_task_get_process(task));
+}
+
 /*! \brief Check wether a task is enabled or not
  * \ingroup group_os_public_api
  * \param task The task to be checked
@@ -219,6 +430,67 @@ static inline struct os_task *os_task_get_current(void) {
 	return NULL;
 }
 
+#if CONFIG_OS_USE_TASK_NOTIFY == true
+/*! \brief Notify a task. Its notification word is updated, and the task is
+ * waken up if it waits for a notification. This function can be called from
+ * an interrupt.
+ * \ingroup group_os_public_api
+ * \param task The task to notify
+ * \param value The value used by the action (ignored by
+ * \ref OS_TASK_NOTIFY_GIVE)
+ * \param action How the notification word is updated
+ * (\ref os_task_notify_action)
+ * \pre \ref CONFIG_OS_USE_TASK_NOTIFY needs to be set
+ */
+void os_task_notify(struct os_task *task, uint32_t value,
+		enum os_task_notify_action action);
+
+/*! \brief Notify a task, by incrementing its notification word
+ * \ingroup group_os_public_api
+ * \param task The task to notify
+ * \pre \ref CONFIG_OS_USE_TASK_NOTIFY needs to be set
+ */
+static inline void os_task_notify_give(struct os_task *task) {
+	os_task_notify(task, 0, OS_TASK_NOTIFY_GIVE);
+}
+
+/*! \brief Wait for a notification of the current task. If a notification is
+ * already pending, this function returns immediately.
+ * \ingroup group_os_public_api
+ * \param clear_on_exit Bits of the notification word cleared before
+ * returning. Use 0xffffffff to reset the word.
+ * \return The notification word, before its bits are cleared. If the caller
+ * is not a task, 0 is returned straight away.
+ * \pre \ref CONFIG_OS_USE_TASK_NOTIFY needs to be set
+ * \pre This function must be called by a task.
+ */
+uint32_t os_task_notify_wait(uint32_t clear_on_exit);
+
+/*! \brief Take a unit of the notification word of the current task, used as
+ * the count of a counting semaphore (\ref os_task_notify_give). The task
+ * waits while the count is null. The units left stay pending, so the next
+ * call returns immediately.
+ * \ingroup group_os_public_api
+ * \param clear_on_exit Take all the units at once if set, like a binary
+ * semaphore. Only one unit is taken otherwise.
+ * \return The count, before it is decremented or cleared. If the caller is
+ * not a task, 0 is returned straight away.
+ * \pre \ref CONFIG_OS_USE_TASK_NOTIFY needs to be set
+ * \pre This function must be called by a task.
+ */
+uint32_t os_task_notify_take(bool clear_on_exit);
+
+/*! \brief Read the notification word of a task
+ * \ingroup group_os_public_api
+ * \param task The task
+ * \return The notification word
+ * \pre \ref CONFIG_OS_USE_TASK_NOTIFY needs to be set
+ */
+static inline uint32_t os_task_notify_get(struct os_task *task) {
+	return task->notify_value;
+}
+#endif
+
 #if CONFIG_OS_USE_EVENTS == true
 
 /*! \brief Send the task to sleep and wake it up uppon a specific event
@@ -250,6 +522,40 @@ static inline struct os_task *os_task_get_current(void) {
 				__VA_ARGS__); \
 		} while (false);
 
+/*! \brief Send the task to sleep and wake it up uppon one of the events of an
+ * array. Unlike \ref os_task_sleep, the number of events does not need to be
+ * known at compile time.
+ * \ingroup group_os_public_api
+ * \param events Array of pointers on the events (\ref os_event) used to
+ * wakeup the task
+ * \param nb_events The number of events in the array
+ * \pre \ref CONFIG_OS_USE_EVENTS needs to be set
+ */
+#define os_task_sleep_array(events, nb_events) \
+		do { \
+			struct os_queue_event __queue_elt[nb_events]; \
+			__os_process_sleep_array(__os_process_get_current(), \
+				__queue_elt, events, nb_events); \
+		} while (false)
+
+/*! \brief Send the task to sleep and wake it up uppon one of the events of an
+ * array.
+ * \ingroup group_os_public_api
+ * \param event_triggered An empty \ref os_event pointer which will point on
+ * the event which triggered the wake up of the process.
+ * \param events Array of pointers on the events (\ref os_event) used to
+ * wakeup the task
+ * \param nb_events The number of events in the array
+ * \pre \ref CONFIG_OS_USE_EVENTS needs to be set
+ */
+#define os_task_sleep_array_ex(event_triggered, events, nb_events) \
+		do { \
+			struct os_queue_event __queue_elt[nb_events]; \
+			event_triggered = __os_process_sleep_array( \
+					__os_process_get_current(), \
+				__queue_elt, events, nb_events); \
+		} while (false)
+
 #endif
 
 /*!
@@ -0,0 +1,82 @@
+/*! \file
+ * \brief eeOS Time Base
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+#if CONFIG_OS_USE_TIME == true
+
+/*! \brief Time base, updated by the tick interrupt
+ */
+static volatile struct {
+	/*! \brief Sequence counter, odd while an update is in progress */
+	uint32_t seq;
+	/*! \brief Time at the last tick in nanoseconds */
+	os_time_t base;
+	/*! \brief Number of counts of the tick timer per tick interrupt */
+	os_cy_t top;
+	/*! \brief Nanoseconds per tick interrupt */
+	os_time_t interval;
+	/*! \brief Nanoseconds per count of the tick timer, in Q16 format */
+	uint64_t scale;
+} __os_time = {
+	.seq = 0,
+	.base = 0,
+	.top = 0,
+	.interval = OS_TIME_NS_PER_TICK,
+	.scale = 0,
+};
+
+void __os_time_tick(void)
+{
+	os_cy_t top = os_get_tick_timer_top();
+
+	/* Notify the readers that an update is in progress */
+	__os_time.seq++;
+	__os_time.base += __os_time.interval;
+	/* Update the sub-tick scale if the tick timer has been re-programmed */
+	if (top != __os_time.top) {
+		__os_time.top = top;
+		__os_time.interval = (os_time_t) __os_tick_get_step()
+				* OS_TIME_NS_PER_TICK;
+		__os_time.scale = (__os_time.interval << 16) / top;
+	}
+	__os_time.seq++;
+}
+
+os_time_t os_time_now(void)
+{
+	uint32_t seq;
+	os_time_t base;
+	os_cy_t top, timer;
+	uint64_t scale;
+
+	/* Read a consistent snapshot of the time base. The tick timer must be
+	 * read within the snapshot too, so that both parts match.
+	 */
+	do {
+		seq = __os_time.seq;
+		base = __os_time.base;
+		top = __os_time.top;
+		scale = __os_time.scale;
+		timer = os_read_tick_timer();
+	} while ((seq & 1) || seq != __os_time.seq);
+	/* Never go beyond the next tick */
+	if (top && timer >= top) {
+		timer = top - 1;
+	}
+
+	return base + (((uint64_t) timer * scale) >> 16);
+}
+
+#endif
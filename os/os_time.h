@@ -0,0 +1,125 @@
+/*! \file
+ * \brief eeOS Time Base
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_TIME_H__
+#define __OS_TIME_H__
+
+/*! \addtogroup group_os
+ * \section section_os_time Time Base
+ *
+ * \ref os_time_now returns a 64-bit monotonic time (\ref os_time_t) in
+ * nanoseconds since the start of the scheduler. It does not wrap in practice
+ * (more than 500 years), so no wrap-around handling is needed when comparing
+ * 2 timestamps.
+ *
+ * The time is the combination of the time at the last tick, updated by the
+ * tick interrupt, and of the current value of the timer generating the ticks
+ * (\ref os_read_tick_timer) for the sub-tick part. Its resolution is therefore
+ * the one of this timer, the CPU cycle with the
+ * \ref CONFIG_OS_SCHEDULER_USE_COMPARE scheduler.
+ *
+ * The reader does not disable the interrupts: the tick interrupt updates the
+ * time base under a sequence counter, and the reader retries if the counter
+ * has changed during its read.
+ *
+ * \note The sub-tick part restarts from 0 as soon as the tick timer wraps. If
+ * the time is read from a critical region while the tick interrupt is pending,
+ * it can then be slightly behind a value read just before.
+ */
+
+/* Configuration options ******************************************************/
+
+/*! \def CONFIG_OS_USE_TIME
+ * \brief Use this option to enable the 64-bit monotonic time base.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_SCHEDULER_TYPE must not be
+ * \ref CONFIG_OS_SCHEDULER_COOPERATIVE.
+ */
+#ifndef CONFIG_OS_USE_TIME
+	#define CONFIG_OS_USE_TIME false
+#endif
+#if CONFIG_OS_USE_TIME == true && \
+		CONFIG_OS_SCHEDULER_TYPE == CONFIG_OS_SCHEDULER_COOPERATIVE
+	#error The time base needs the tick interrupt. CONFIG_OS_SCHEDULER_TYPE\
+			must be set to something else than\
+			CONFIG_OS_SCHEDULER_COOPERATIVE.
+#endif
+
+/* Macros *********************************************************************/
+
+/*! \brief Number of nanoseconds per tick
+ */
+#define OS_TIME_NS_PER_TICK (1000000000ULL / CONFIG_OS_TICK_HZ)
+
+/*! \brief Convert microseconds into \ref os_time_t
+ * \ingroup group_os_public_api
+ */
+#define OS_TIME_US(time_us) ((os_time_t) (time_us) * 1000ULL)
+/*! \brief Convert milliseconds into \ref os_time_t
+ * \ingroup group_os_public_api
+ */
+#define OS_TIME_MS(time_ms) ((os_time_t) (time_ms) * 1000000ULL)
+/*! \brief Convert seconds into \ref os_time_t
+ * \ingroup group_os_public_api
+ */
+#define OS_TIME_S(time_s) ((os_time_t) (time_s) * 1000000000ULL)
+
+#if CONFIG_OS_USE_TIME == true
+	/*! \brief Hook used to update the time base at each tick.
+	 */
+	#define __HOOK_OS_TIME_TICK() \
+		do { \
+			__os_time_tick(); \
+		} while (false)
+#else
+	#define __HOOK_OS_TIME_TICK()
+#endif
+
+/* Types **********************************************************************/
+
+/*! \brief Monotonic time in nanoseconds
+ */
+typedef uint64_t os_time_t;
+
+/* Internal API ***************************************************************/
+
+#if CONFIG_OS_USE_TIME == true
+/*! \brief Update the time base.
+ * \ingroup group_os_internal_api
+ * \warning This function must be called from the tick interrupt.
+ */
+void __os_time_tick(void);
+#endif
+
+/* Public API *****************************************************************/
+
+#if CONFIG_OS_USE_TIME == true
+/*! \name Time Base
+ *
+ * \{
+ */
+
+/*! \brief Get the current monotonic time
+ * \ingroup group_os_public_api
+ * \return The time in nanoseconds since the start of the scheduler
+ * \pre \ref CONFIG_OS_USE_TIME needs to be set
+ */
+os_time_t os_time_now(void);
+
+/*!
+ * \}
+ */
+#endif
+
+#endif // __OS_TIME_H__
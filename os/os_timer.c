@@ -0,0 +1,240 @@
+/*! \file
+ * \brief eeOS Software Timers
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#include "os_core.h"
+
+#if CONFIG_OS_USE_TIMER == true
+
+/*! \brief Mask of a timing wheel index
+ */
+#define OS_TIMER_WHEEL_MASK (OS_TIMER_WHEEL_SIZE - 1)
+/*! \brief Number of ticks covered by the timing wheel
+ */
+#define OS_TIMER_WHEEL_RANGE (1UL << (OS_TIMER_WHEEL_BITS * OS_TIMER_WHEEL_LEVELS))
+
+/*! \brief The timing wheel. Each slot holds a list of armed timers.
+ */
+static struct os_queue_doubly *__os_timer_wheel[OS_TIMER_WHEEL_LEVELS][OS_TIMER_WHEEL_SIZE];
+
+/*! \brief Current time of the timing wheel. It follows \ref os_tick_counter.
+ */
+static os_tick_t __os_timer_time = 0;
+
+/*! \brief List of the expired timers, which callbacks are pending.
+ */
+static struct os_queue_doubly *__os_timer_expired = NULL;
+
+/*! \brief Stack of the timer daemon.
+ */
+static OS_MALLOC_STACK(__os_timer_stack, CONFIG_OS_TIMER_STACK_SIZE);
+
+/*! \brief Context of the timer daemon. Its stack pointer is set only when the
+ * process is created, the first time a timer is started.
+ */
+static struct os_process __os_timer_process = {
+	.sp = NULL,
+	.status = OS_PROCESS_IDLE,
+	.type = OS_PROCESS_TYPE_TIMER,
+};
+
+/*! \brief Insert an armed timer in the timing wheel.
+ * \param timer The timer
+ * \warning This function must be called inside a critical section.
+ */
+static void __os_timer_insert(struct os_timer *timer)
+{
+	os_tick_t when = timer->expires;
+	uint32_t delta = (os_tick_t) (when - __os_timer_time);
+	int level;
+
+	/* Park the timers beyond the range of the wheel in the last slot */
+	if (delta >= OS_TIMER_WHEEL_RANGE) {
+		delta = OS_TIMER_WHEEL_RANGE - 1;
+		when = __os_timer_time + (os_tick_t) delta;
+	}
+	/* Look for the level matching the remaining time */
+	for (level = 0; level < OS_TIMER_WHEEL_LEVELS - 1; level++) {
+		if (delta < (1UL << (OS_TIMER_WHEEL_BITS * (level + 1)))) {
+			break;
+		}
+	}
+	os_queue_doubly_insert_first(&__os_timer_wheel[level][
+			(when >> (OS_TIMER_WHEEL_BITS * level))
+			& OS_TIMER_WHEEL_MASK], &timer->elt);
+}
+
+/*! \brief Re-insert all the timers of a slot, they will move to the lower
+ * levels of the wheel.
+ * \param slot The slot
+ */
+static void __os_timer_cascade(struct os_queue_doubly **slot)
+{
+	struct os_queue_doubly *list = *slot;
+	struct os_queue_doubly *elt;
+
+	*slot = NULL;
+	while (list) {
+		elt = list;
+		list = list->next;
+		__os_timer_insert((struct os_timer *) elt);
+	}
+}
+
+/*! \brief Entry point of the timer daemon. It runs the callbacks of the
+ * expired timers, and disables itself when no more callbacks are pending.
+ * \param args Not used
+ */
+static void __os_timer_process_handler(os_ptr_t args)
+{
+	struct os_timer *timer;
+	os_proc_ptr_t callback;
+	os_ptr_t callback_args;
+	os_tick_t period;
+
+	while (true) {
+		os_enter_critical();
+		/* Sleep until a timer expires */
+		if (!__os_timer_expired) {
+			__os_process_disable(&__os_timer_process);
+			os_leave_critical();
+			continue;
+		}
+		timer = (struct os_timer *) os_queue_doubly_pop(&__os_timer_expired);
+		callback = timer->callback;
+		callback_args = timer->args;
+		if (timer->mode == OS_TIMER_AUTO_RELOAD) {
+			/* Re-arm the timer from its previous expiration to avoid
+			 * any drift, unless this one is already in the past.
+			 */
+			period = (timer->period) ? timer->period : 1;
+			timer->expires += period;
+			if ((os_tick_t) (timer->expires - __os_timer_time - 1)
+					>= period) {
+				timer->expires = __os_timer_time + period;
+			}
+			__os_timer_insert(timer);
+			timer->status = OS_TIMER_ARMED;
+		}
+		else {
+			timer->status = OS_TIMER_STOPPED;
+		}
+		os_leave_critical();
+		/* Run the callback outside of the critical region */
+		callback(callback_args);
+	}
+}
+
+void __os_timer_tick(void)
+{
+	extern volatile os_tick_t os_tick_counter;
+	struct os_queue_doubly **slot;
+	struct os_timer *timer;
+	os_tick_t time;
+	int level;
+
+	/* Catch up with the tick counter */
+	while (__os_timer_time != os_tick_counter) {
+		time = ++__os_timer_time;
+		/* Cascade the upper levels when the lower level wraps */
+		for (level = 1; level < OS_TIMER_WHEEL_LEVELS; level++) {
+			if (time & OS_TIMER_WHEEL_MASK) {
+				break;
+			}
+			time >>= OS_TIMER_WHEEL_BITS;
+			__os_timer_cascade(&__os_timer_wheel[level][
+					time & OS_TIMER_WHEEL_MASK]);
+		}
+		/* Move the expired timers to the timer daemon */
+		slot = &__os_timer_wheel[0][__os_timer_time & OS_TIMER_WHEEL_MASK];
+		while (*slot) {
+			timer = (struct os_timer *) os_queue_doubly_pop(slot);
+			timer->status = OS_TIMER_EXPIRED;
+			os_queue_doubly_insert_first(&__os_timer_expired,
+					&timer->elt);
+		}
+	}
+	/* Wake up the timer daemon if needed */
+	if (__os_timer_expired && __os_timer_process.sp
+			&& !__os_process_is_enabled(&__os_timer_process)) {
+		__os_process_enable_naked(&__os_timer_process);
+	}
+}
+
+void os_timer_create(struct os_timer *timer, os_proc_ptr_t callback,
+		os_ptr_t args, os_tick_t period, enum os_timer_mode mode)
+{
+	timer->callback = callback;
+	timer->args = args;
+	timer->period = period;
+	timer->mode = mode;
+	timer->status = OS_TIMER_STOPPED;
+}
+
+void os_timer_start(struct os_timer *timer)
+{
+	extern volatile os_tick_t os_tick_counter;
+	/* Check if the current process is running inside a critical region. */
+	bool is_critical = os_is_critical();
+	/* The following code is critical, so enter in the critial region if
+	 * not already done.
+	 */
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Create the timer daemon if not done already */
+	if (!__os_timer_process.sp) {
+		__os_process_create(&__os_timer_process,
+				&__os_timer_stack[CONFIG_OS_TIMER_STACK_SIZE],
+				OS_PROCESS_TYPE_TIMER);
+#if CONFIG_OS_USE_PRIORITY == true
+		__os_process_set_priority(&__os_timer_process,
+				CONFIG_OS_TIMER_PRIORITY);
+#endif
+		os_process_context_load(&__os_timer_process,
+				__os_timer_process_handler, NULL);
+		/* The wheel is empty, synchronize it with the tick counter */
+		__os_timer_time = os_tick_counter;
+	}
+	/* Restart the timer if it is already running */
+	if (timer->status != OS_TIMER_STOPPED) {
+		os_queue_doubly_remove(&timer->elt);
+	}
+	/* A timer expires at the earliest on the next tick */
+	timer->expires = __os_timer_time + ((timer->period) ? timer->period : 1);
+	__os_timer_insert(timer);
+	timer->status = OS_TIMER_ARMED;
+	/* Leave the critical region if the process was not previously in. */
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+void os_timer_stop(struct os_timer *timer)
+{
+	bool is_critical = os_is_critical();
+
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	/* Remove the timer from the wheel or from the expired list */
+	if (timer->status != OS_TIMER_STOPPED) {
+		os_queue_doubly_remove(&timer->elt);
+		timer->status = OS_TIMER_STOPPED;
+	}
+	if (!is_critical) {
+		os_leave_critical();
+	}
+}
+
+#endif
@@ -0,0 +1,239 @@
+/*! \file
+ * \brief eeOS Software Timers
+ * \author Blaise Lengrand (blaise.lengrand@gmail.com)
+ * \version 0.1
+ * \date 2011
+ *
+ * \section eeos_license License
+ * \ref group_os is provided in source form for FREE evaluation, for
+ * educational use or for peaceful research. If you plan on using \ref group_os
+ * in a commercial product you need to contact the author to properly license
+ * its use in your product. The fact that the  source is provided does
+ * NOT mean that you can use it without paying a licensing fee.
+ */
+
+#ifndef __OS_TIMER_H__
+#define __OS_TIMER_H__
+
+/*! \addtogroup group_os
+ * \section section_os_timer Software Timers
+ *
+ * A software timer (\ref os_timer) calls a function after a given number of
+ * ticks, once (\ref OS_TIMER_ONE_SHOT) or periodically
+ * (\ref OS_TIMER_AUTO_RELOAD). Timers do not need their own stack, their
+ * callbacks all run within a single process, the timer daemon, with its own
+ * stack (\ref CONFIG_OS_TIMER_STACK_SIZE) and priority
+ * (\ref CONFIG_OS_TIMER_PRIORITY). The timer daemon is part of the active
+ * process list only while some callbacks are pending.
+ *
+ * Armed timers are stored in a hierarchical timing wheel of
+ * \ref OS_TIMER_WHEEL_LEVELS levels of \ref OS_TIMER_WHEEL_SIZE slots each. The
+ * first level has a resolution of 1 tick, each following level has a
+ * resolution \ref OS_TIMER_WHEEL_SIZE times coarser. A timer is placed at the
+ * level matching its remaining time, and moved down to the lower level when
+ * the wheel reaches its slot. Starting or stopping a timer costs O(1), and so
+ * does each tick, whatever the number of armed timers (the cascade of a slot
+ * is amortized over the ticks of the level below).
+ *
+ * \code
+ * static void my_callback(os_ptr_t args);
+ * struct os_timer my_timer;
+ * os_timer_create(&my_timer, my_callback, NULL, OS_MS_TO_TICKS(100),
+ *		OS_TIMER_AUTO_RELOAD);
+ * os_timer_start(&my_timer);
+ * \endcode
+ */
+
+/* Configuration options ******************************************************/
+
+/*! \def CONFIG_OS_USE_TIMER
+ * \brief Use this option to enable the software timers support.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_TICK_COUNTER needs to be set
+ */
+#ifndef CONFIG_OS_USE_TIMER
+	#define CONFIG_OS_USE_TIMER false
+#endif
+#if CONFIG_OS_USE_TIMER == true && CONFIG_OS_USE_TICK_COUNTER == false
+	#error The software timers need the tick counter. CONFIG_OS_USE_TICK_COUNTER\
+			must be set.
+#endif
+
+/*! \def CONFIG_OS_TIMER_STACK_SIZE
+ * \brief Size in bytes of the stack used by the timer daemon. All the timer
+ * callbacks run on this stack.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_TIMER needs to be set
+ */
+#ifndef CONFIG_OS_TIMER_STACK_SIZE
+	#define CONFIG_OS_TIMER_STACK_SIZE 512
+#endif
+
+/*! \def CONFIG_OS_TIMER_PRIORITY
+ * \brief Priority assigned to the timer daemon.
+ * \ingroup group_os_config
+ * \pre \ref CONFIG_OS_USE_TIMER and \ref CONFIG_OS_USE_PRIORITY need to be
+ * set
+ */
+#ifndef CONFIG_OS_TIMER_PRIORITY
+	#define CONFIG_OS_TIMER_PRIORITY OS_PRIORITY_1
+#endif
+
+/* Macros *********************************************************************/
+
+/*! \brief Number of bits of a timing wheel index
+ */
+#define OS_TIMER_WHEEL_BITS 6
+/*! \brief Number of slots per level of the timing wheel
+ */
+#define OS_TIMER_WHEEL_SIZE (1 << OS_TIMER_WHEEL_BITS)
+/*! \brief Number of levels of the timing wheel. Timers expiring beyond the
+ * range of the wheel are parked in its last slot and re-inserted later.
+ */
+#define OS_TIMER_WHEEL_LEVELS 4
+
+#if CONFIG_OS_USE_TIMER == true
+	/*! \brief Hook used to advance the timing wheel at each tick.
+	 */
+	#define __HOOK_OS_TIMER_TICK() \
+		do { \
+			__os_timer_tick(); \
+		} while (false)
+#else
+	#define __HOOK_OS_TIMER_TICK()
+#endif
+
+/* Types **********************************************************************/
+
+/*! \brief Mode of a timer
+ */
+enum os_timer_mode {
+	/*! \brief The timer expires once and stops
+	 */
+	OS_TIMER_ONE_SHOT = 0,
+	/*! \brief The timer is re-armed with the same period each time it
+	 * expires
+	 */
+	OS_TIMER_AUTO_RELOAD = 1,
+};
+
+/*! \brief Status of a timer
+ */
+enum os_timer_status {
+	/*! \brief The timer is stopped
+	 */
+	OS_TIMER_STOPPED = 0,
+	/*! \brief The timer is armed and stored in the timing wheel
+	 */
+	OS_TIMER_ARMED = 1,
+	/*! \brief The timer has expired and its callback is pending
+	 */
+	OS_TIMER_EXPIRED = 2,
+};
+
+#if CONFIG_OS_USE_TIMER == true
+/*! \brief Software timer
+ */
+struct os_timer {
+	/*! \brief Element of the slot (or expired) list. It must be the first
+	 * member of the structure.
+	 */
+	struct os_queue_doubly elt;
+	/*! \brief Absolute expiration tick
+	 */
+	os_tick_t expires;
+	/*! \brief Number of ticks between 2 expirations
+	 */
+	os_tick_t period;
+	/*! \brief Function called when the timer expires
+	 */
+	os_proc_ptr_t callback;
+	/*! \brief Arguments passed to the callback
+	 */
+	os_ptr_t args;
+	/*! \brief Mode of the timer (\ref os_timer_mode)
+	 */
+	uint8_t mode;
+	/*! \brief Status of the timer (\ref os_timer_status)
+	 */
+	volatile uint8_t status;
+};
+#endif
+
+/* Internal API ***************************************************************/
+
+#if CONFIG_OS_USE_TIMER == true
+/*! \brief Advance the timing wheel up to the current tick and move the
+ * expired timers to the timer daemon.
+ * \ingroup group_os_internal_api
+ * \warning This function must be called from the tick interrupt.
+ */
+void __os_timer_tick(void);
+#endif
+
+/* Public API *****************************************************************/
+
+#if CONFIG_OS_USE_TIMER == true
+/*! \name Software Timers
+ *
+ * Set of functions to manage software timers
+ *
+ * \{
+ */
+
+/*! \brief Create a software timer. The timer is stopped.
+ * \ingroup group_os_public_api
+ * \param timer The timer to be initialized
+ * \param callback The function to call when the timer expires. It runs within
+ * the timer daemon, so it must not block.
+ * \param args Arguments passed to the callback
+ * \param period The number of ticks before the timer expires
+ * \param mode The mode of the timer (\ref os_timer_mode)
+ * \pre \ref CONFIG_OS_USE_TIMER needs to be set
+ */
+void os_timer_create(struct os_timer *timer, os_proc_ptr_t callback,
+		os_ptr_t args, os_tick_t period, enum os_timer_mode mode);
+
+/*! \brief Start (or restart) a timer. It will expire after its period.
+ * \ingroup group_os_public_api
+ * \param timer The timer
+ * \pre \ref CONFIG_OS_USE_TIMER needs to be set
+ */
+void os_timer_start(struct os_timer *timer);
+
+/*! \brief Stop a timer. If its callback is pending, it will not be called.
+ * \ingroup group_os_public_api
+ * \param timer The timer
+ * \pre \ref CONFIG_OS_USE_TIMER needs to be set
+ */
+void os_timer_stop(struct os_timer *timer);
+
+/*! \brief Change the period of a timer. It will be used from the next start or
+ * the next reload.
+ * \ingroup group_os_public_api
+ * \param timer The timer
+ * \param period The new period in ticks
+ * \pre \ref CONFIG_OS_USE_TIMER needs to be set
+ */
+static inline void os_timer_set_period(struct os_timer *timer,
+		os_tick_t period) {
+	timer->period = period;
+}
+
+/*! \brief Check if a timer is running
+ * \ingroup group_os_public_api
+ * \param timer The timer
+ * \return true if the timer is armed or its callback is pending, false
+ * otherwise.
+ * \pre \ref CONFIG_OS_USE_TIMER needs to be set
+ */
+static inline bool os_timer_is_active(struct os_timer *timer) {
+	return (timer->status != OS_TIMER_STOPPED);
+}
+
+/*!
+ * \}
+ */
+#endif
+
+#endif // __OS_TIMER_H__
@@ -96,12 +96,86 @@ typedef uint32_t os_intptr_t;
 typedef uint32_t os_reg_t;
 typedef uint32_t os_cy_t;
 
+/*! Atomically replace the content of a word if it holds an expected value.
+ * It does not mask the interrupts: the store is conditional (\b stcond) and
+ * fails if an interrupt or an exception occurs since the value has been read,
+ * in which case the sequence is tried again.
+ * \param ptr The word
+ * \param old_value The expected value
+ * \param new_value The value to store
+ * \return true if the word held the expected value and has been replaced,
+ * false otherwise.
+ */
+static inline bool os_atomic_cas(volatile os_reg_t *ptr, os_reg_t old_value,
+		os_reg_t new_value) {
+#if __GNUC__
+	os_reg_t value;
+	__asm__ __volatile__ (
+		"1:\n\t"
+		"ssrf\t5\n\t"
+		"ld.w\t%[value], %[ptr]\n\t"
+		"cp.w\t%[value], %[old_value]\n\t"
+		"brne\t2f\n\t"
+		"stcond\t%[ptr], %[new_value]\n\t"
+		"brne\t1b\n\t"
+		"2:\n\t"
+		: [value] "=&r" (value), [ptr] "+m" (*ptr)
+		: [old_value] "r" (old_value), [new_value] "r" (new_value)
+		: "memory", "cc"
+	);
+	return (value == old_value);
+#elif __ICCAVR32__
+	bool is_swapped = false;
+	bool is_critical = os_is_critical();
+	if (!is_critical) {
+		os_enter_critical();
+	}
+	if (*ptr == old_value) {
+		*ptr = new_value;
+		is_swapped = true;
+	}
+	if (!is_critical) {
+		os_leave_critical();
+	}
+	return is_swapped;
+#endif
+}
+
 /*! Benchmark ports
  */
 static inline os_cy_t os_read_cycle_counter(void) {
 	return Get_system_register(AVR32_COUNT);
 }
 
+/*! Read the current value of the timer generating the ticks. It counts from 0
+ * to \ref os_get_tick_timer_top - 1 within a tick.
+ */
+os_cy_t os_read_tick_timer(void);
+
+/*! Get the number of counts of the timer generating the ticks per tick.
+ */
+os_cy_t os_get_tick_timer_top(void);
+
+/*! Read the time in cycles of the compare unit shared with the high-resolution
+ * timers. It wraps on 32 bits. This function must be called inside a critical
+ * section.
+ * \pre \ref CONFIG_OS_SCHEDULER_USE_COMPARE must be used
+ */
+os_cy_t os_read_hrtimer(void);
+
+/*! Program the compare unit with the earliest of the next tick and of an
+ * alarm. This function must be called inside a critical section.
+ * \param is_armed false if there is no alarm
+ * \param when Time of the alarm in cycles (\ref os_read_hrtimer)
+ * \pre \ref CONFIG_OS_SCHEDULER_USE_COMPARE must be used
+ */
+void os_set_hrtimer_alarm(bool is_armed, os_cy_t when);
+
+/*! Check if the last match of the compare unit is a tick or only an alarm.
+ * \pre \ref CONFIG_OS_SCHEDULER_USE_COMPARE must be used
+ */
+bool os_hrtimer_is_tick(void);
+
 /*! Get the entry point of the memory allocated for the application stack.
  */
 static inline os_ptr_t os_get_app_stack(void) {
@@ -24,11 +24,54 @@
 			*((uint32_t *) (proc)->sp) = (uint32_t) (value); \
 		} while (false)
 
+#if CONFIG_OS_USE_TICK_RATE == true
+/*! \brief Frequency of the peripheral generating the ticks, used to change the
+ * tick rate.
+ */
+static uint32_t __os_port_ref_hz;
+#endif
+
 #if CONFIG_OS_SCHEDULER_TYPE == CONFIG_OS_SCHEDULER_USE_COMPARE
 	/* Setup functions to use the compare interrupt
 	 */
+#if CONFIG_OS_USE_HRTIMER == true
+	/* The compare unit is shared with the high-resolution timers. The cycle
+	 * counter is still reset at each compare match, so a free-running time
+	 * is rebuilt by accumulating the compare values.
+	 */
+
+	/*! \brief Time in cycles of the last compare match */
+	static os_cy_t __os_port_base = 0;
+	/*! \brief Current value of the compare register */
+	static os_cy_t __os_port_compare;
+	/*! \brief Number of cycles per tick interrupt */
+	static os_cy_t __os_port_period;
+	/*! \brief Time in cycles of the next tick */
+	static os_cy_t __os_port_next_tick;
+	/*! \brief Time in cycles of the next alarm */
+	static os_cy_t __os_port_alarm;
+	/*! \brief Set if an alarm is programmed */
+	static bool __os_port_is_alarm = false;
+	/*! \brief Set if the last compare match is a tick */
+	static bool __os_port_is_tick = false;
+
+	/* Check if a compare match is waiting to be handled */
+	static inline bool __os_port_is_compare_pending(void) {
+		return (AVR32_INTC.irr[AVR32_CORE_COMPARE_IRQ / 32]
+				& (1UL << (AVR32_CORE_COMPARE_IRQ % 32))) ? true : false;
+	}
+#endif
+
 	void os_setup_scheduler(uint32_t cpu_freq_hz)
 	{
+#if CONFIG_OS_USE_TICK_RATE == true
+		__os_port_ref_hz = cpu_freq_hz;
+#endif
+#if CONFIG_OS_USE_HRTIMER == true
+		__os_port_period = cpu_freq_hz / CONFIG_OS_TICK_HZ;
+		__os_port_compare = __os_port_period;
+		__os_port_next_tick = __os_port_period;
+#endif
 		cpu_irq_disable();
 		irq_initialize_vectors();
 		irq_register_handler((__int_handler) os_switch_context_int_handler,
@@ -38,9 +81,121 @@
 		cpu_irq_enable();
 	}
 
+#if CONFIG_OS_USE_HRTIMER == true
+	static inline void os_scheduler_clear_int(void) {
+		/* Account for the cycles elapsed until this match */
+		__os_port_base += __os_port_compare;
+		__os_port_is_tick = ((int32_t) (__os_port_base
+				- __os_port_next_tick) >= 0);
+		if (__os_port_is_tick) {
+			__os_port_next_tick += __os_port_period;
+		}
+		Set_system_register(AVR32_COMPARE, __os_port_compare);
+	}
+
+	os_cy_t os_read_hrtimer(void)
+	{
+		bool is_pending;
+		os_cy_t count;
+
+		/* Make sure the counter has not been reset in between */
+		do {
+			is_pending = __os_port_is_compare_pending();
+			count = Get_system_register(AVR32_COUNT);
+		} while (is_pending != __os_port_is_compare_pending());
+		/* A pending match has already reset the counter */
+		if (is_pending) {
+			count += __os_port_compare;
+		}
+		return __os_port_base + count;
+	}
+
+	void os_set_hrtimer_alarm(bool is_armed, os_cy_t when)
+	{
+		os_cy_t target = __os_port_next_tick;
+		os_cy_t count;
+
+		__os_port_alarm = when;
+		__os_port_is_alarm = is_armed;
+		/* The compare register will be updated by the pending (or
+		 * imminent) match, writing it now would clear the interrupt.
+		 */
+		count = Get_system_register(AVR32_COUNT);
+		if (__os_port_is_compare_pending() || __os_port_compare - count
+				<= CONFIG_OS_HRTIMER_MIN_CY) {
+			return;
+		}
+		/* Program the earliest of the next tick and the alarm */
+		if (is_armed && (int32_t) (when - target) < 0) {
+			target = when;
+		}
+		target -= __os_port_base;
+		if ((int32_t) (target - count) <= CONFIG_OS_HRTIMER_MIN_CY) {
+			target = count + CONFIG_OS_HRTIMER_MIN_CY;
+		}
+		__os_port_compare = target;
+		Set_system_register(AVR32_COMPARE, target);
+	}
+
+	bool os_hrtimer_is_tick(void)
+	{
+		return __os_port_is_tick;
+	}
+#else
 	static inline void os_scheduler_clear_int(void) {
 		Set_system_register(AVR32_COMPARE, Get_system_register(AVR32_COMPARE));
 	}
+#endif
+
+#if CONFIG_OS_USE_TICK_RATE == true
+	void os_setup_tick_rate(uint32_t tick_hz)
+	{
+#if CONFIG_OS_USE_HRTIMER == true
+		/* The next tick has already been scheduled with the previous
+		 * period.
+		 */
+		__os_port_next_tick -= __os_port_period;
+		__os_port_period = __os_port_ref_hz / tick_hz;
+		__os_port_next_tick += __os_port_period;
+		os_set_hrtimer_alarm(__os_port_is_alarm, __os_port_alarm);
+#else
+		Set_system_register(AVR32_COMPARE, __os_port_ref_hz / tick_hz);
+#endif
+	}
+#endif
+
+#if CONFIG_OS_USE_HRTIMER == true
+	os_cy_t os_read_tick_timer(void)
+	{
+		bool is_critical = os_is_critical();
+		os_cy_t timer;
+
+		if (!is_critical) {
+			os_enter_critical();
+		}
+		timer = os_read_hrtimer() - (__os_port_next_tick - __os_port_period);
+		if (!is_critical) {
+			os_leave_critical();
+		}
+		return timer;
+	}
+
+	os_cy_t os_get_tick_timer_top(void)
+	{
+		return __os_port_period;
+	}
+#else
+	/* The cycle counter is reset at each compare match */
+	os_cy_t os_read_tick_timer(void)
+	{
+		return Get_system_register(AVR32_COUNT);
+	}
+
+	os_cy_t os_get_tick_timer_top(void)
+	{
+		return Get_system_register(AVR32_COMPARE);
+	}
+#endif
 
 	#define OS_SCHEDULER_IRQ_GROUP AVR32_CORE_IRQ_GROUP
 
@@ -67,6 +222,23 @@
 		(&AVR32_RTC)->icr = AVR32_RTC_ICR_TOPI_MASK;
 	}
 
+#if CONFIG_OS_USE_TICK_RATE == true
+	void os_setup_tick_rate(uint32_t tick_hz)
+	{
+		rtc_set_top_value(&AVR32_RTC, 28750 / tick_hz);
+	}
+#endif
+
+	os_cy_t os_read_tick_timer(void)
+	{
+		return (&AVR32_RTC)->val;
+	}
+
+	os_cy_t os_get_tick_timer_top(void)
+	{
+		return (&AVR32_RTC)->top + 1;
+	}
+
 	#define OS_SCHEDULER_IRQ_GROUP AVR32_RTC_IRQ_GROUP
 
 #elif CONFIG_OS_SCHEDULER_TYPE == CONFIG_OS_SCHEDULER_USE_TC
@@ -109,6 +281,9 @@
 			.lovrs = 0,
 			.covfs = 0,
 		};
+#if CONFIG_OS_USE_TICK_RATE == true
+		__os_port_ref_hz = pba_freq_hz;
+#endif
 		cpu_irq_disable();
 		irq_initialize_vectors();
 		irq_register_handler((__int_handler) os_switch_context_int_handler,
@@ -126,12 +301,41 @@
 		AVR32_TC.channel[CONFIG_OS_SCHEDULER_TC_CHANNEL].sr;
 	}
 
+#if CONFIG_OS_USE_TICK_RATE == true
+	void os_setup_tick_rate(uint32_t tick_hz)
+	{
+		tc_write_rc(&AVR32_TC, CONFIG_OS_SCHEDULER_TC_CHANNEL,
+				(__os_port_ref_hz + 4 * tick_hz) / (8 * tick_hz));
+	}
+#endif
+
+	os_cy_t os_read_tick_timer(void)
+	{
+		return AVR32_TC.channel[CONFIG_OS_SCHEDULER_TC_CHANNEL].cv;
+	}
+
+	os_cy_t os_get_tick_timer_top(void)
+	{
+		return AVR32_TC.channel[CONFIG_OS_SCHEDULER_TC_CHANNEL].rc;
+	}
+
 	#define OS_SCHEDULER_IRQ_GROUP AVR32_TC_IRQ_GROUP
 
 #else
 
 	static inline void os_scheduler_clear_int(void) {
 	}
+
+	os_cy_t os_read_tick_timer(void)
+	{
+		return 0;
+	}
+
+	os_cy_t os_get_tick_timer_top(void)
+	{
+		return 1;
+	}
+
 	#define OS_SCHEDULER_IRQ_GROUP 0
 #endif
 
@@ -159,7 +363,8 @@ ISR(os_switch_context_int_handler, OS_SCHEDULER_IRQ_GROUP,
 
 	// Clear the interrupt flag
 	os_scheduler_clear_int();
-	__os_switch_context_int_handler_hook();
+	// The new process is returned in r12, this must be an out-of-line call
+	__os_switch_context_int_handler_next();
 
 	__asm__ __volatile__ (
 		// Update the stack pointer
@@ -223,7 +428,8 @@ __exception void _os_switch_context(void)
 
 	__HOOK_OS_STATISTICS_SWITCH_CONTEXT_START(34);
 
-	__os_switch_context_hook();
+	// The new process is returned in r12, this must be an out-of-line call
+	__os_switch_context_next();
 
 	__asm__ __volatile__ (
 		// Update the stack pointer